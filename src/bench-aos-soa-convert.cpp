@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+struct User
+{
+    int32_t Id;
+    float Balance;
+    bool Active;
+};
+
+/* The transpose kernels treat the records as a flat array of 32-bit words,
+ * three per user: [Id, Balance, Active + padding]. */
+static_assert(sizeof(User) == 3 * sizeof(float), "User must be 12 bytes");
+static_assert(offsetof(User, Balance) == 1 * sizeof(float),
+              "User::Balance must be the second word");
+static_assert(offsetof(User, Active) == 2 * sizeof(float),
+              "User::Active must start the third word");
+
+struct IUserRepository
+{
+    virtual ~IUserRepository() = default;
+    virtual void ForEach(const std::function<void(const User&)>& fn) const = 0;
+    virtual std::optional<User> FindById(int32_t id) const = 0;
+};
+
+class VectorUserRepository final : public IUserRepository
+{
+public:
+    explicit VectorUserRepository(const std::vector<User>& users)
+        : Users(users)
+    {
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (const User& user : Users) {
+            fn(user);
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        for (const User& user : Users) {
+            if (user.Id == id) {
+                return user;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    std::vector<User> Users;
+};
+
+struct MutableUsersView
+{
+    int32_t* RESTRICT_ALIAS Ids;
+    float* RESTRICT_ALIAS Balances;
+    uint8_t* RESTRICT_ALIAS Active;
+    std::size_t Count;
+};
+
+/* Rows handed to each converter thread start on a multiple of this, so every
+ * thread's slice of the 64-byte aligned SoA columns starts 32-byte aligned. */
+constexpr std::size_t ConvertGrainRows = 32;
+
+/* Splits [0, count) into one contiguous, grain-aligned range per thread and
+ * runs `fn(begin, end)` on each; a single thread runs inline. */
+template <class F>
+void ParallelForRows(const std::size_t count, const std::size_t threadsCount,
+                     F&& fn)
+{
+    if (threadsCount <= 1) {
+        fn(std::size_t{0}, count);
+        return;
+    }
+
+    const std::size_t rowsPerThread =
+        ((count + threadsCount - 1) / threadsCount + ConvertGrainRows - 1)
+        / ConvertGrainRows * ConvertGrainRows;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadsCount);
+
+    for (std::size_t begin = 0; begin < count; begin += rowsPerThread) {
+        const std::size_t end = std::min(count, begin + rowsPerThread);
+        workers.emplace_back([&fn, begin, end] { fn(begin, end); });
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+/* The per-field copy loop a migration would write today. */
+FORCE_NOINLINE void ConvertAosToSoaScalar(
+    const std::span<const User> users, const MutableUsersView& columns)
+{
+    for (std::size_t i = 0; i < users.size(); ++i) {
+        columns.Ids[i] = users[i].Id;
+        columns.Balances[i] = users[i].Balance;
+        columns.Active[i] = users[i].Active ? 1u : 0u;
+    }
+}
+
+FORCE_NOINLINE void ConvertSoaToAosScalar(
+    const UsersView& usersView, const std::span<User> users)
+{
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        users[i] = User{
+            usersView.Ids[i],
+            usersView.Balances[i],
+            usersView.Active[i] != 0,
+        };
+    }
+}
+
+#if defined(__AVX2__)
+template <bool bStreaming>
+void Store256(void* const destination, const __m256i value)
+{
+    if constexpr (bStreaming) {
+        _mm256_stream_si256(static_cast<__m256i*>(destination), value);
+    } else {
+        _mm256_store_si256(static_cast<__m256i*>(destination), value);
+    }
+}
+
+/* Eight records are 24 words, i.e. three 256-bit loads. Field f of record k
+ * sits at word 3k + f; for each field those eight positions fall into eight
+ * distinct lanes (position % 8), so two blends collect a field into one
+ * register and a lane permute puts it in record order. The SoA -> AoS direction
+ * runs the inverse permutes, which for ids and flags are the same ones. */
+struct TransposeOrders
+{
+    __m256i Ids = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+    __m256i BalancesToRows = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+    __m256i RowsToBalances = _mm256_setr_epi32(5, 0, 3, 6, 1, 4, 7, 2);
+    __m256i Active = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+};
+
+/* Converts rows [begin, end); `begin` is a multiple of ConvertGrainRows. */
+template <bool bStreaming>
+void ConvertAosToSoaAvx2Range(const User* const users,
+                              const MutableUsersView& columns,
+                              const std::size_t begin, const std::size_t end)
+{
+    const TransposeOrders orders;
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i flagsOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    const std::size_t vectorEnd =
+        begin + (end - begin) / ConvertGrainRows * ConvertGrainRows;
+
+    std::size_t i = begin;
+    for (; i < vectorEnd; i += ConvertGrainRows) {
+        __m256i activeWords[ConvertGrainRows / 8];
+
+        for (std::size_t g = 0; g < ConvertGrainRows / 8; ++g) {
+            const std::size_t row = i + g * 8;
+            const float* words = reinterpret_cast<const float*>(users + row);
+
+            __m256 w0 = _mm256_loadu_ps(words);
+            __m256 w1 = _mm256_loadu_ps(words + 8);
+            __m256 w2 = _mm256_loadu_ps(words + 16);
+
+            __m256 ids = _mm256_blend_ps(_mm256_blend_ps(w0, w1, 0x92), w2, 0x24);
+            ids = _mm256_permutevar8x32_ps(ids, orders.Ids);
+
+            __m256 b = _mm256_blend_ps(_mm256_blend_ps(w0, w1, 0x24), w2, 0x49);
+            b = _mm256_permutevar8x32_ps(b, orders.BalancesToRows);
+
+            __m256 a = _mm256_blend_ps(_mm256_blend_ps(w0, w1, 0x49), w2, 0x92);
+            a = _mm256_permutevar8x32_ps(a, orders.Active);
+
+            Store256<bStreaming>(columns.Ids + row, _mm256_castps_si256(ids));
+            Store256<bStreaming>(columns.Balances + row, _mm256_castps_si256(b));
+
+            /* Only the low byte of the Active word is the bool. */
+            activeWords[g] = _mm256_and_si256(_mm256_castps_si256(a), byteMask);
+        }
+
+        /* Narrows 4 x 8 flag words to 32 bytes. The packs work per 128-bit
+         * lane, which leaves 4-row groups interleaved; the permute restores
+         * row order. */
+        const __m256i words01 = _mm256_packus_epi32(activeWords[0], activeWords[1]);
+        const __m256i words23 = _mm256_packus_epi32(activeWords[2], activeWords[3]);
+        __m256i flags = _mm256_packus_epi16(words01, words23);
+        flags = _mm256_permutevar8x32_epi32(flags, flagsOrder);
+
+        Store256<bStreaming>(columns.Active + i, flags);
+    }
+
+    for (; i < end; ++i) {
+        columns.Ids[i] = users[i].Id;
+        columns.Balances[i] = users[i].Balance;
+        columns.Active[i] = users[i].Active ? 1u : 0u;
+    }
+
+    if constexpr (bStreaming) {
+        _mm_sfence();
+    }
+}
+
+/* Converts rows [begin, end). A few leading rows are copied one by one until
+ * the output reaches a 32-byte boundary; from there every 8 records are 96
+ * bytes, so all three stores per group stay aligned. */
+template <bool bStreaming>
+void ConvertSoaToAosAvx2Range(const UsersView& usersView, User* const users,
+                              const std::size_t begin, const std::size_t end)
+{
+    const TransposeOrders orders;
+
+    std::size_t i = begin;
+    for (; i < end && reinterpret_cast<std::uintptr_t>(users + i) % 32 != 0; ++i) {
+        users[i] = User{
+            usersView.Ids[i], usersView.Balances[i], usersView.Active[i] != 0,
+        };
+    }
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t vectorEnd = i + (end - i) / vectorWidth * vectorWidth;
+
+    for (; i < vectorEnd; i += vectorWidth) {
+        __m256 ids = _mm256_castsi256_ps(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(usersView.Ids + i)));
+        __m256 b = _mm256_loadu_ps(usersView.Balances + i);
+        __m256 a = _mm256_castsi256_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(
+            reinterpret_cast<const __m128i*>(usersView.Active + i))));
+
+        ids = _mm256_permutevar8x32_ps(ids, orders.Ids);
+        b = _mm256_permutevar8x32_ps(b, orders.RowsToBalances);
+        a = _mm256_permutevar8x32_ps(a, orders.Active);
+
+        /* Word lanes: w0 = I B A I B A I B, w1 = A I B A I B A I,
+         * w2 = B A I B A I B A. */
+        const __m256 w0 = _mm256_blend_ps(_mm256_blend_ps(ids, b, 0x92), a, 0x24);
+        const __m256 w1 = _mm256_blend_ps(_mm256_blend_ps(ids, b, 0x24), a, 0x49);
+        const __m256 w2 = _mm256_blend_ps(_mm256_blend_ps(ids, b, 0x49), a, 0x92);
+
+        float* words = reinterpret_cast<float*>(users + i);
+        Store256<bStreaming>(words, _mm256_castps_si256(w0));
+        Store256<bStreaming>(words + 8, _mm256_castps_si256(w1));
+        Store256<bStreaming>(words + 16, _mm256_castps_si256(w2));
+    }
+
+    for (; i < end; ++i) {
+        users[i] = User{
+            usersView.Ids[i], usersView.Balances[i], usersView.Active[i] != 0,
+        };
+    }
+
+    if constexpr (bStreaming) {
+        _mm_sfence();
+    }
+}
+
+template <bool bStreaming>
+FORCE_NOINLINE void ConvertAosToSoaAvx2(
+    const std::span<const User> users, const MutableUsersView& columns,
+    const std::size_t threadsCount)
+{
+    ParallelForRows(users.size(), threadsCount,
+                    [&](const std::size_t begin, const std::size_t end) {
+        ConvertAosToSoaAvx2Range<bStreaming>(users.data(), columns, begin, end);
+    });
+}
+
+template <bool bStreaming>
+FORCE_NOINLINE void ConvertSoaToAosAvx2(
+    const UsersView& usersView, const std::span<User> users,
+    const std::size_t threadsCount)
+{
+    ParallelForRows(usersView.Count, threadsCount,
+                    [&](const std::size_t begin, const std::size_t end) {
+        ConvertSoaToAosAvx2Range<bStreaming>(usersView, users.data(), begin, end);
+    });
+}
+#endif  /* defined(__AVX2__) */
+
+FORCE_NOINLINE float SumActiveBalances(
+    const IUserRepository& repository, float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    repository.ForEach([&](const User& user) {
+        if (user.Active && user.Balance >= minimumBalance) {
+            accumulatedBalance += user.Balance;
+        }
+    });
+
+    return accumulatedBalance;
+}
+
+[[nodiscard]] std::size_t CountMismatches(const std::span<const User> users,
+                                          const UsersView& usersView)
+{
+    std::size_t mismatches = 0;
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        const bool bMatches = users[i].Id == usersView.Ids[i]
+            && users[i].Balance == usersView.Balances[i]
+            && users[i].Active == (usersView.Active[i] != 0)
+            && usersView.Active[i] <= 1;
+        mismatches += bMatches ? 0u : 1u;
+    }
+
+    return mismatches;
+}
+
+struct ConversionResults
+{
+    const char* Direction;
+    const char* Name;
+    std::size_t ThreadsCount;
+    std::size_t Mismatches;
+    double AverageTimeSeconds;
+};
+
+template <class F>
+double MeasureAverageTime(const std::size_t warmupIterations,
+                          const std::size_t iterations, F&& f)
+{
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        (void)f();
+    }
+
+    return MeasureExecutionTime(iterations, f) / static_cast<double>(iterations);
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+
+    const std::size_t threadsCount =
+        std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+    std::println("");
+    std::println("[ AoS <-> SoA Conversion Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Threads           : {}", threadsCount);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    /* The records are the conversion source, so the rows are generated into
+     * a scratch table and written out as records; the table below is only
+     * ever filled by the converters being measured. */
+    std::vector<User> users(elementsCount);
+    {
+        UsersTable generatedUsers;
+        GenerateUsers(generatedUsers, elementsCount, randomEngine);
+        ConvertSoaToAosScalar(MakeUsersView(generatedUsers), users);
+    }
+
+    UsersTable table;
+    table.Resize(elementsCount);
+
+    const MutableUsersView columns{
+        table.Column<UserSchema::Id>().data(),
+        table.Column<UserSchema::Balance>().data(),
+        table.Column<UserSchema::Active>().data(),
+        table.Size(),
+    };
+    const UsersView usersView = MakeUsersView(table);
+
+    std::vector<User> roundTripUsers(elementsCount);
+
+    std::println("");
+    std::println("Benchmarking conversions...");
+
+    std::vector<ConversionResults> conversions;
+
+    const auto measureAosToSoa = [&](const char* name,
+                                     const std::size_t threads, auto&& convert) {
+        std::fill_n(columns.Active, elementsCount, uint8_t{0xAA});
+        const double seconds =
+            MeasureAverageTime(warmupIterations, iterations, [&] {
+                convert();
+                return columns.Balances[elementsCount - 1];
+            });
+        conversions.push_back(ConversionResults{
+            "AoS -> SoA", name, threads, CountMismatches(users, usersView),
+            seconds,
+        });
+    };
+
+    const auto measureSoaToAos = [&](const char* name,
+                                     const std::size_t threads, auto&& convert) {
+        std::fill(roundTripUsers.begin(), roundTripUsers.end(),
+                  User{-1, -1.0f, false});
+        const double seconds =
+            MeasureAverageTime(warmupIterations, iterations, [&] {
+                convert();
+                return roundTripUsers.back().Balance;
+            });
+        conversions.push_back(ConversionResults{
+            "SoA -> AoS", name, threads,
+            CountMismatches(roundTripUsers, usersView), seconds,
+        });
+    };
+
+    measureAosToSoa("Scalar", 1, [&] {
+        ConvertAosToSoaScalar(users, columns);
+    });
+#if defined(__AVX2__)
+    measureAosToSoa("AVX2", 1, [&] {
+        ConvertAosToSoaAvx2<false>(users, columns, 1);
+    });
+    measureAosToSoa("AVX2", threadsCount, [&] {
+        ConvertAosToSoaAvx2<false>(users, columns, threadsCount);
+    });
+    measureAosToSoa("AVX2 Streaming", threadsCount, [&] {
+        ConvertAosToSoaAvx2<true>(users, columns, threadsCount);
+    });
+#endif  /* defined(__AVX2__) */
+
+    measureSoaToAos("Scalar", 1, [&] {
+        ConvertSoaToAosScalar(usersView, roundTripUsers);
+    });
+#if defined(__AVX2__)
+    measureSoaToAos("AVX2", 1, [&] {
+        ConvertSoaToAosAvx2<false>(usersView, roundTripUsers, 1);
+    });
+    measureSoaToAos("AVX2", threadsCount, [&] {
+        ConvertSoaToAosAvx2<false>(usersView, roundTripUsers, threadsCount);
+    });
+    measureSoaToAos("AVX2 Streaming", threadsCount, [&] {
+        ConvertSoaToAosAvx2<true>(usersView, roundTripUsers, threadsCount);
+    });
+#endif  /* defined(__AVX2__) */
+
+    std::println("Benchmarking scans...");
+
+    VectorUserRepository repository{users};
+
+    float repositoryChecksum = 0.0f;
+    float soaChecksum = 0.0f;
+
+    const double repositorySeconds =
+        MeasureAverageTime(warmupIterations, iterations, [&] {
+            repositoryChecksum = SumActiveBalances(repository, minimumBalance);
+            return repositoryChecksum;
+        });
+    const double soaSeconds =
+        MeasureAverageTime(warmupIterations, iterations, [&] {
+            soaChecksum = SumActiveBalancesScalar(usersView, minimumBalance);
+            return soaChecksum;
+        });
+
+    /* Every conversion reads one layout and writes the other in full. */
+    constexpr double bytesMoved =
+        static_cast<double>(elementsCount)
+        * (sizeof(User) + sizeof(int32_t) + sizeof(float) + sizeof(uint8_t));
+
+    std::println("");
+    std::println("[ Conversion Results ]");
+    std::println("{:<10} | {:<14} | {:>7} | {:>10} | {:>10} | {:>10}",
+                 "Direction", "Variant", "Threads", "Time (ms)", "GB/s",
+                 "Mismatches");
+
+    double bestAosToSoaSeconds = 0.0;
+    for (const ConversionResults& conversion : conversions) {
+        std::println("{:<10} | {:<14} | {:>7} | {:>10.2f} | {:>10.2f} | {:>10}",
+                     conversion.Direction, conversion.Name,
+                     conversion.ThreadsCount,
+                     conversion.AverageTimeSeconds * 1e3,
+                     bytesMoved / conversion.AverageTimeSeconds / 1e9,
+                     conversion.Mismatches);
+
+        if (conversion.Direction == conversions.front().Direction
+            && (bestAosToSoaSeconds == 0.0
+                || conversion.AverageTimeSeconds < bestAosToSoaSeconds)) {
+            bestAosToSoaSeconds = conversion.AverageTimeSeconds;
+        }
+    }
+
+    const double savedSecondsPerScan = repositorySeconds - soaSeconds;
+
+    std::println("");
+    std::println("[ Break-Even Results ]");
+    std::println("Repository Scan Checksum   : {:.2f}", repositoryChecksum);
+    std::println("SoA Scan Checksum          : {:.2f}", soaChecksum);
+    std::println("Repository Scan            : {:.2f} ms", repositorySeconds * 1e3);
+    std::println("SoA Scan                   : {:.2f} ms", soaSeconds * 1e3);
+    std::println("Scalar Conversion          : {:.2f} ms",
+                 conversions.front().AverageTimeSeconds * 1e3);
+    std::println("Best Conversion            : {:.2f} ms",
+                 bestAosToSoaSeconds * 1e3);
+
+    if (savedSecondsPerScan > 0.0) {
+        std::println("Scans to Repay Scalar      : {:.0f}", std::ceil(
+            conversions.front().AverageTimeSeconds / savedSecondsPerScan));
+        std::println("Scans to Repay Best        : {:.0f}", std::ceil(
+            bestAosToSoaSeconds / savedSecondsPerScan));
+    } else {
+        std::println("Scans to Repay             : never (SoA scan is not faster)");
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/* Exact reference. A float is `mantissa * 2^(exponent - 150)`, so summing
+ * the integer mantissas per biased exponent loses nothing (10^9 * 2^24 fits
+ * in 63 bits); only the final combination of the 256 partial sums rounds,
+ * in long double, far below double precision. */
+FORCE_NOINLINE double SumActiveBalancesExact(
+    const UsersView &usersView, const float minimumBalance)
+{
+    std::array<int64_t, 256> mantissaSums{};
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        const float balanceValue = usersView.Balances[i];
+        if (!usersView.Active[i] || !(balanceValue >= minimumBalance)) {
+            continue;
+        }
+
+        const uint32_t bits = std::bit_cast<uint32_t>(balanceValue);
+        uint32_t exponent = (bits >> 23) & 0xFFu;
+        int64_t mantissa = static_cast<int64_t>(bits & 0x7FFFFFu);
+
+        if (exponent != 0) {
+            mantissa |= 0x800000;
+        } else {
+            exponent = 1;
+        }
+
+        mantissaSums[exponent] += (bits >> 31) != 0 ? -mantissa : mantissa;
+    }
+
+    long double accumulatedBalance = 0.0L;
+    for (std::size_t exponent = 0; exponent < mantissaSums.size(); ++exponent) {
+        accumulatedBalance += std::ldexp(
+            static_cast<long double>(mantissaSums[exponent]),
+            static_cast<int32_t>(exponent) - 150);
+    }
+
+    return static_cast<double>(accumulatedBalance);
+}
+
+#if defined(__AVX2__)
+/* Float lanes all the way down: the speed target, and the accuracy floor. */
+FORCE_NOINLINE double SumActiveBalancesAvx2Float(
+    const UsersView& usersView, float minimumBalance)
+{
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    constexpr std::size_t vectorWidth = 16;
+    const std::size_t n16 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n16; i += vectorWidth) {
+        __m256 b0 = _mm256_loadu_ps(balances + i);
+        __m128i a8_0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i));
+        __m256 active0 = _mm256_min_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(a8_0)), one);
+        __m256 cmp0 = _mm256_cmp_ps(b0, threshold, _CMP_GE_OQ);
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(b0, _mm256_and_ps(cmp0, active0)));
+
+        __m256 b1 = _mm256_loadu_ps(balances + i + 8);
+        __m128i a8_1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i + 8));
+        __m256 active1 = _mm256_min_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(a8_1)), one);
+        __m256 cmp1 = _mm256_cmp_ps(b1, threshold, _CMP_GE_OQ);
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(b1, _mm256_and_ps(cmp1, active1)));
+    }
+
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+
+    double accumulatedBalance = static_cast<double>(_mm_cvtss_f32(sum));
+
+    for (; i < count; ++i) {
+        if (activeFlags[i] && balances[i] >= minimumBalance) {
+            accumulatedBalance += static_cast<double>(balances[i]);
+        }
+    }
+
+    return accumulatedBalance;
+}
+
+/* Hierarchical accumulation: float lanes over blocks of `blockElements`
+ * elements, flushed into double totals once per block. Each float lane only
+ * ever holds the sum of 64 balances, so its rounding error stays tiny, while
+ * the hot loop runs at the float kernel's width and the widening cost is
+ * paid once per 1K elements instead of once per 8. */
+FORCE_NOINLINE double SumActiveBalancesAvx2Blocked(
+    const UsersView& usersView, float minimumBalance)
+{
+    constexpr std::size_t blockElements = 1024;
+    constexpr std::size_t vectorWidth = 16;
+
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256d total0 = _mm256_setzero_pd();
+    __m256d total1 = _mm256_setzero_pd();
+
+    const std::size_t n16 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    while (i < n16) {
+        const std::size_t blockEnd = std::min(i + blockElements, n16);
+
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+
+        for (; i < blockEnd; i += vectorWidth) {
+            __m256 b0 = _mm256_loadu_ps(balances + i);
+            __m128i a8_0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i));
+            __m256 active0 = _mm256_min_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(a8_0)), one);
+            __m256 cmp0 = _mm256_cmp_ps(b0, threshold, _CMP_GE_OQ);
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(b0, _mm256_and_ps(cmp0, active0)));
+
+            __m256 b1 = _mm256_loadu_ps(balances + i + 8);
+            __m128i a8_1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i + 8));
+            __m256 active1 = _mm256_min_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(a8_1)), one);
+            __m256 cmp1 = _mm256_cmp_ps(b1, threshold, _CMP_GE_OQ);
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(b1, _mm256_and_ps(cmp1, active1)));
+        }
+
+        total0 = _mm256_add_pd(total0, _mm256_cvtps_pd(_mm256_castps256_ps128(acc0)));
+        total1 = _mm256_add_pd(total1, _mm256_cvtps_pd(_mm256_extractf128_ps(acc0, 1)));
+        total0 = _mm256_add_pd(total0, _mm256_cvtps_pd(_mm256_castps256_ps128(acc1)));
+        total1 = _mm256_add_pd(total1, _mm256_cvtps_pd(_mm256_extractf128_ps(acc1, 1)));
+    }
+
+    __m256d total = _mm256_add_pd(total0, total1);
+    __m128d low = _mm256_castpd256_pd128(total);
+    __m128d high = _mm256_extractf128_pd(total, 1);
+    __m128d sum = _mm_add_pd(low, high);
+    double accumulatedBalance =
+        _mm_cvtsd_f64(sum) + _mm_cvtsd_f64(_mm_unpackhi_pd(sum, sum));
+
+    for (; i < count; ++i) {
+        if (activeFlags[i] && balances[i] >= minimumBalance) {
+            accumulatedBalance += static_cast<double>(balances[i]);
+        }
+    }
+
+    return accumulatedBalance;
+}
+#endif  /* defined(__AVX2__) */
+
+FORCE_NOINLINE double SumActiveBalancesDouble(
+    const UsersView &usersView, const float minimumBalance)
+{
+#if defined(__AVX2__)
+#if COMPILER_CLANG || COMPILER_GCC
+    if (__builtin_cpu_supports("avx2")) {
+        return SumActiveBalancesAvx2Blocked(usersView, minimumBalance);
+    }
+#endif  /* COMPILER_CLANG || COMPILER_GCC */
+    return SumActiveBalancesScalarDouble(usersView, minimumBalance);
+#else  /* defined(__AVX2__) */
+    return SumActiveBalancesScalarDouble(usersView, minimumBalance);
+#endif  /* defined(__AVX2__) */
+}
+
+void PrintResults(const char* title, const double checksum,
+                  const double exactChecksum, const double totalTimeSeconds,
+                  const std::size_t iterations, const std::size_t elementsCount)
+{
+    const double averageTimeSeconds = totalTimeSeconds / iterations;
+    const double elementsPerSecond =
+        static_cast<double>(elementsCount) / averageTimeSeconds;
+    const double nanosecondsPerElement =
+        (averageTimeSeconds * 1e9) / static_cast<double>(elementsCount);
+    const double absoluteError = std::abs(checksum - exactChecksum);
+
+    std::println("");
+    std::println("[ {} ]", title);
+    std::println("Checksum                   : {:.8f}", checksum);
+    std::println("Absolute Error             : {:.8f}", absoluteError);
+    std::println("Relative Error             : {:.3e}",
+                 absoluteError / std::abs(exactChecksum));
+    std::println("Total Time                 : {:.2f} s", totalTimeSeconds);
+    std::println("Average Time per Iteration : {:.2f} s", averageTimeSeconds);
+    std::println("Elements per Second        : {:.2f} M", elementsPerSecond / 1e6);
+    std::println("Nanoseconds per Element    : {:.2f}", nanosecondsPerElement);
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 1'000'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+
+    std::println("");
+    std::println("[ DoD AVX2 Blocked Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    std::println("");
+    std::println("Computing exact reference...");
+
+    const double exactChecksum =
+        SumActiveBalancesExact(usersView, minimumBalance);
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    const auto measure = [&](double& checksum, auto&& kernel) {
+        for (std::size_t i = 0; i < warmupIterations; ++i) {
+            checksum = kernel(usersView, minimumBalance);
+        }
+
+        return MeasureExecutionTime(iterations, [&] {
+            return kernel(usersView, minimumBalance);
+        });
+    };
+
+    double scalarChecksum = 0.0;
+    const double scalarTimeSeconds =
+        measure(scalarChecksum, SumActiveBalancesScalarDouble);
+
+#if defined(__AVX2__)
+    double floatChecksum = 0.0;
+    const double floatTimeSeconds =
+        measure(floatChecksum, SumActiveBalancesAvx2Float);
+
+    double wideningChecksum = 0.0;
+    const double wideningTimeSeconds =
+        measure(wideningChecksum, SumActiveBalancesAvx2Double);
+#endif  /* defined(__AVX2__) */
+
+    double blockedChecksum = 0.0;
+    const double blockedTimeSeconds =
+        measure(blockedChecksum, SumActiveBalancesDouble);
+
+    std::println("");
+    std::println("[ Exact Reference ]");
+    std::println("Checksum                   : {:.8f}", exactChecksum);
+
+    PrintResults("DoD Scalar Double Results", scalarChecksum, exactChecksum,
+                 scalarTimeSeconds, iterations, elementsCount);
+#if defined(__AVX2__)
+    PrintResults("DoD AVX2 Float Results", floatChecksum, exactChecksum,
+                 floatTimeSeconds, iterations, elementsCount);
+    PrintResults("DoD AVX2 Widening Double Results", wideningChecksum,
+                 exactChecksum, wideningTimeSeconds, iterations, elementsCount);
+#endif  /* defined(__AVX2__) */
+    PrintResults("DoD AVX2 Blocked Results", blockedChecksum, exactChecksum,
+                 blockedTimeSeconds, iterations, elementsCount);
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -4,103 +4,13 @@
 #include <cstdlib>
 #include <print>
 #include <random>
+#include <span>
 #include <string>
 #include <vector>
 
-#include <immintrin.h>
-
+#include "dod-users.hpp"
 #include "lib.hpp"
 
-struct UsersView
-{
-    const int32_t* RESTRICT_ALIAS Ids;
-    const float* RESTRICT_ALIAS Balances;
-    const uint8_t* RESTRICT_ALIAS Active;
-    std::size_t Count;
-};
-
-FORCE_NOINLINE float SumActiveBalancesScalar(
-    const UsersView &usersView, const float minimumBalance)
-{
-    float accumulatedBalance = 0.0f;
-    const float thresholdBalance = minimumBalance;
-
-    for (std::size_t i = 0; i < usersView.Count; ++i) {
-        const float balanceValue = usersView.Balances[i];
-        const float takeValue =
-            (usersView.Active[i] && balanceValue >= thresholdBalance)
-                ? 1.0f : 0.0f;
-        accumulatedBalance += balanceValue * takeValue;
-    }
-
-    return accumulatedBalance;
-}
-
-#if defined(__AVX2__)
-FORCE_NOINLINE float SumActiveBalancesAvx2(
-    const UsersView& usersView, float minimumBalance)
-{
-    const std::size_t count = usersView.Count;
-    const float* RESTRICT_ALIAS balances = usersView.Balances;
-    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
-
-    const __m256 threshold = _mm256_set1_ps(minimumBalance);
-    const __m256 one = _mm256_set1_ps(1.0f);
-
-    __m256 acc = _mm256_setzero_ps();
-
-    constexpr std::size_t vectorWidth = 8;
-    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
-
-    std::size_t i = 0;
-    for (; i < n8; i += vectorWidth) {
-        __m256 b = _mm256_loadu_ps(&balances[i]);
-
-        __m128i bytes =
-            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&activeFlags[i]));
-        __m256i ints =_mm256_cvtepu8_epi32(bytes);
-        __m256 activeM = _mm256_min_ps(_mm256_cvtepi32_ps(ints), one);
-
-        __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
-        __m256 take =_mm256_and_ps(cmpMask, activeM);
-        __m256 contrib = _mm256_mul_ps(b, take);
-
-        acc = _mm256_add_ps(acc, contrib);
-    }
-
-    __m128 low =_mm256_castps256_ps128(acc);
-    __m128 high = _mm256_extractf128_ps(acc, 1);
-    __m128 sum =_mm_add_ps(low, high);
-    sum =_mm_hadd_ps(sum, sum);
-    sum =_mm_hadd_ps(sum, sum);
-    float accumulatedBalance = _mm_cvtss_f32(sum);
-
-    for (; i < count; ++i) {
-        if (activeFlags[i] && balances[i] >= minimumBalance) {
-            accumulatedBalance += balances[i];
-        }
-    }
-
-    return accumulatedBalance;
-}
-#endif /* defined(__AVX2__) */
-
-
-FORCE_NOINLINE float SumActiveBalances(
-    const UsersView &usersView, const float minimumBalance)
-{
-#if defined(__AVX2__)
-#if COMPILER_CLANG || COMPILER_GCC
-    if (__builtin_cpu_supports("avx2")) {
-        return SumActiveBalancesAvx2(usersView, minimumBalance);
-    }
-#endif  /* COMPILER_CLANG || COMPILER_GCC */
-    return SumActiveBalancesScalar(usersView, minimumBalance);
-#else  /* defined(__AVX2__) */
-    return SumActiveBalancesScalar(usersView, minimumBalance);
-#endif  /* defined(__AVX2__) */
-}
-
 int32_t main()
 {
     constexpr std::size_t elementsCount = 10'000'000;
@@ -118,28 +28,14 @@ int32_t main()
     std::println("Iterations        : {}", iterations);
 
     std::mt19937 randomEngine{randomSeed};
-    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
-    std::bernoulli_distribution           activeDistribution{0.6};
 
     std::println("");
     std::println("Generating elements...");
 
-    std::vector<std::int32_t> userIds(elementsCount);
-    std::vector<float> userBalances(elementsCount);
-    std::vector<std::uint8_t> userActiveFlags(elementsCount);
-
-    for (std::size_t i = 0; i < elementsCount; ++i) {
-        userIds[i] = static_cast<std::int32_t>(i);
-        userBalances[i] = balanceDistribution(randomEngine);
-        userActiveFlags[i] = activeDistribution(randomEngine) ? 1u : 0u;
-    }
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
 
-    UsersView usersView{
-        userIds.data(),
-        userBalances.data(),
-        userActiveFlags.data(),
-        elementsCount,
-    };
+    const UsersView usersView = MakeUsersView(users);
 
     std::println("");
     std::println("Warming up...");
@@ -0,0 +1,522 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/* Balances are indexed as fixed-point cents: 0.00 .. 1000.00 is 0 .. 100000,
+ * which fits in 17 bits. */
+constexpr std::size_t SliceCount = 17;
+constexpr uint32_t CentsPerUnit = 100;
+constexpr uint32_t MaximumCents = 1000 * CentsPerUnit;
+static_assert(MaximumCents < (uint32_t{1} << SliceCount),
+              "Balance range does not fit in the slices");
+
+[[nodiscard]] uint32_t ToCents(const float balance)
+{
+    return static_cast<uint32_t>(
+        std::lround(static_cast<double>(balance) * CentsPerUnit));
+}
+
+/* Bit-sliced index: slice s is a bitmap of bit s of every row's cents. Rows
+ * are grouped in 256-row blocks, and a block stores its 17 slice vectors and
+ * then its active vector back to back. Range evaluation and the SUM walk the
+ * slices of one block at a time, so the whole index is read as a single
+ * sequential stream of 2.25 bytes per row. */
+class BitSlicedIndex
+{
+public:
+    static constexpr std::size_t BlockRows = 256;
+    static constexpr std::size_t BlockWords = BlockRows / 64;
+    static constexpr std::size_t VectorsPerBlock = SliceCount + 1;
+
+    explicit BitSlicedIndex(const UsersView& usersView)
+        : BlocksCount((usersView.Count + BlockRows - 1) / BlockRows)
+        , Words(BlocksCount * VectorsPerBlock * BlockWords, 0)
+    {
+        for (std::size_t i = 0; i < usersView.Count; ++i) {
+            const uint32_t cents = ToCents(usersView.Balances[i]);
+            uint64_t* block = Words.data() + (i / BlockRows) * VectorsPerBlock * BlockWords;
+            const std::size_t word = (i % BlockRows) / 64;
+            const uint64_t bit = uint64_t{1} << (i % 64);
+
+            for (std::size_t s = 0; s < SliceCount; ++s) {
+                if ((cents >> s) & 1u) {
+                    block[s * BlockWords + word] |= bit;
+                }
+            }
+
+            if (usersView.Active[i]) {
+                block[SliceCount * BlockWords + word] |= bit;
+            }
+        }
+    }
+
+    std::size_t GetBlocksCount() const
+    {
+        return BlocksCount;
+    }
+
+    /* Slice s of the block is at `[s * BlockWords]`, the active bitmap at
+     * `[SliceCount * BlockWords]`. */
+    const uint64_t* GetBlock(const std::size_t block) const
+    {
+        return Words.data() + block * VectorsPerBlock * BlockWords;
+    }
+
+    std::size_t GetSizeBytes() const
+    {
+        return Words.size() * sizeof(uint64_t);
+    }
+
+private:
+    std::size_t BlocksCount;
+    AlignedVector<uint64_t> Words;
+};
+
+/* `MinimumCents <= cents < MaximumCents`; a MaximumCents past the slice
+ * range leaves the upper bound open. */
+struct CentsRange
+{
+    uint32_t MinimumCents;
+    uint32_t MaximumCents;
+
+    bool HasMaximum() const
+    {
+        return MaximumCents < (uint32_t{1} << SliceCount);
+    }
+};
+
+struct BsiAggregate
+{
+    uint64_t Count;
+    uint64_t SumCents;
+};
+
+/* O'Neil-Quass comparison against a constant, one word of 64 rows at a time:
+ * walking the slices from the top bit down, `Eq` keeps the rows whose bits so
+ * far equal the constant's and `Gt` collects those that went above it. The
+ * active bitmap seeds `Eq`, and the walk stops early once no row in the word
+ * is still undecided. SUM is then the popcount of the match mask against
+ * each slice, weighted by the slice's bit. */
+FORCE_NOINLINE BsiAggregate SumActiveBalancesBsiScalar(
+    const BitSlicedIndex& index, const CentsRange range)
+{
+    constexpr std::size_t blockWords = BitSlicedIndex::BlockWords;
+
+    uint64_t sliceCounts[SliceCount] = {};
+    uint64_t count = 0;
+
+    const bool bHasMaximum = range.HasMaximum();
+
+    for (std::size_t b = 0; b < index.GetBlocksCount(); ++b) {
+        const uint64_t* block = index.GetBlock(b);
+
+        for (std::size_t w = 0; w < blockWords; ++w) {
+            const uint64_t active = block[SliceCount * blockWords + w];
+
+            uint64_t gtLow = 0;
+            uint64_t eqLow = active;
+            uint64_t gtHigh = 0;
+            uint64_t eqHigh = bHasMaximum ? active : 0;
+
+            for (std::size_t s = SliceCount; s-- > 0 && (eqLow | eqHigh) != 0;) {
+                const uint64_t slice = block[s * blockWords + w];
+
+                if ((range.MinimumCents >> s) & 1u) {
+                    eqLow &= slice;
+                } else {
+                    gtLow |= eqLow & slice;
+                    eqLow &= ~slice;
+                }
+
+                if ((range.MaximumCents >> s) & 1u) {
+                    eqHigh &= slice;
+                } else {
+                    gtHigh |= eqHigh & slice;
+                    eqHigh &= ~slice;
+                }
+            }
+
+            const uint64_t match = (gtLow | eqLow) & ~(gtHigh | eqHigh);
+            if (match == 0) {
+                continue;
+            }
+
+            count += static_cast<uint64_t>(std::popcount(match));
+            for (std::size_t s = 0; s < SliceCount; ++s) {
+                sliceCounts[s] += static_cast<uint64_t>(
+                    std::popcount(match & block[s * blockWords + w]));
+            }
+        }
+    }
+
+    uint64_t sumCents = 0;
+    for (std::size_t s = 0; s < SliceCount; ++s) {
+        sumCents += sliceCounts[s] << s;
+    }
+
+    return BsiAggregate{count, sumCents};
+}
+
+FORCE_NOINLINE float SumActiveBalancesRangeScalar(
+    const UsersView &usersView, const float minimumBalance,
+    const float maximumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        const float balanceValue = usersView.Balances[i];
+        const float takeValue = (usersView.Active[i]
+            && balanceValue >= minimumBalance && balanceValue < maximumBalance)
+                ? 1.0f : 0.0f;
+        accumulatedBalance += balanceValue * takeValue;
+    }
+
+    return accumulatedBalance;
+}
+
+#if defined(__AVX2__)
+/* Per-64-bit-lane population count: nibble lookup with PSHUFB, then SAD
+ * against zero to add the byte counts of each lane. */
+[[nodiscard]] __m256i PopcountLanes(const __m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+
+    const __m256i low = _mm256_and_si256(v, lowMask);
+    const __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+    const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                           _mm256_shuffle_epi8(lookup, high));
+
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+[[nodiscard]] uint64_t HorizontalSum(const __m256i v)
+{
+    return static_cast<uint64_t>(_mm256_extract_epi64(v, 0))
+        + static_cast<uint64_t>(_mm256_extract_epi64(v, 1))
+        + static_cast<uint64_t>(_mm256_extract_epi64(v, 2))
+        + static_cast<uint64_t>(_mm256_extract_epi64(v, 3));
+}
+
+/* Same evaluation as the scalar kernel on a whole 256-row block per step. */
+FORCE_NOINLINE BsiAggregate SumActiveBalancesBsiAvx2(
+    const BitSlicedIndex& index, const CentsRange range)
+{
+    __m256i sliceCounts[SliceCount];
+    for (__m256i& sliceCount : sliceCounts) {
+        sliceCount = _mm256_setzero_si256();
+    }
+    __m256i counts = _mm256_setzero_si256();
+
+    const bool bHasMaximum = range.HasMaximum();
+
+    for (std::size_t b = 0; b < index.GetBlocksCount(); ++b) {
+        const __m256i* block = reinterpret_cast<const __m256i*>(index.GetBlock(b));
+        const __m256i active = _mm256_load_si256(block + SliceCount);
+
+        __m256i gtLow = _mm256_setzero_si256();
+        __m256i eqLow = active;
+        __m256i gtHigh = _mm256_setzero_si256();
+        __m256i eqHigh = bHasMaximum ? active : _mm256_setzero_si256();
+
+        for (std::size_t s = SliceCount; s-- > 0;) {
+            const __m256i undecided = _mm256_or_si256(eqLow, eqHigh);
+            if (_mm256_testz_si256(undecided, undecided)) {
+                break;
+            }
+
+            const __m256i slice = _mm256_load_si256(block + s);
+
+            if ((range.MinimumCents >> s) & 1u) {
+                eqLow = _mm256_and_si256(eqLow, slice);
+            } else {
+                gtLow = _mm256_or_si256(gtLow, _mm256_and_si256(eqLow, slice));
+                eqLow = _mm256_andnot_si256(slice, eqLow);
+            }
+
+            if ((range.MaximumCents >> s) & 1u) {
+                eqHigh = _mm256_and_si256(eqHigh, slice);
+            } else {
+                gtHigh = _mm256_or_si256(gtHigh, _mm256_and_si256(eqHigh, slice));
+                eqHigh = _mm256_andnot_si256(slice, eqHigh);
+            }
+        }
+
+        const __m256i match = _mm256_andnot_si256(
+            _mm256_or_si256(gtHigh, eqHigh), _mm256_or_si256(gtLow, eqLow));
+        if (_mm256_testz_si256(match, match)) {
+            continue;
+        }
+
+        counts = _mm256_add_epi64(counts, PopcountLanes(match));
+        for (std::size_t s = 0; s < SliceCount; ++s) {
+            sliceCounts[s] = _mm256_add_epi64(sliceCounts[s], PopcountLanes(
+                _mm256_and_si256(match, _mm256_load_si256(block + s))));
+        }
+    }
+
+    uint64_t sumCents = 0;
+    for (std::size_t s = 0; s < SliceCount; ++s) {
+        sumCents += HorizontalSum(sliceCounts[s]) << s;
+    }
+
+    return BsiAggregate{HorizontalSum(counts), sumCents};
+}
+
+FORCE_NOINLINE float SumActiveBalancesRangeAvx2(
+    const UsersView& usersView, float minimumBalance, float maximumBalance)
+{
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    const __m256 lowThreshold = _mm256_set1_ps(minimumBalance);
+    const __m256 highThreshold = _mm256_set1_ps(maximumBalance);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 acc = _mm256_setzero_ps();
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n8; i += vectorWidth) {
+        __m256 b = _mm256_loadu_ps(&balances[i]);
+
+        __m128i bytes =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&activeFlags[i]));
+        __m256i ints = _mm256_cvtepu8_epi32(bytes);
+        __m256 activeM = _mm256_min_ps(_mm256_cvtepi32_ps(ints), one);
+
+        __m256 cmpMask = _mm256_and_ps(
+            _mm256_cmp_ps(b, lowThreshold, _CMP_GE_OQ),
+            _mm256_cmp_ps(b, highThreshold, _CMP_LT_OQ));
+        __m256 take = _mm256_and_ps(cmpMask, activeM);
+        __m256 contrib = _mm256_mul_ps(b, take);
+
+        acc = _mm256_add_ps(acc, contrib);
+    }
+
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    float accumulatedBalance = _mm_cvtss_f32(sum);
+
+    for (; i < count; ++i) {
+        if (activeFlags[i] && balances[i] >= minimumBalance
+            && balances[i] < maximumBalance) {
+            accumulatedBalance += balances[i];
+        }
+    }
+
+    return accumulatedBalance;
+}
+#endif  /* defined(__AVX2__) */
+
+struct BalanceQuery
+{
+    const char* Name;
+    float MinimumBalance;
+    float MaximumBalance;
+};
+
+struct QueryResults
+{
+    const char* Name;
+    double Selectivity;
+    float FloatChecksum;
+    double BsiChecksum;
+    double ExactChecksum;
+    bool bCountMatches;
+    double FloatScalarSeconds;
+    double FloatAvx2Seconds;
+    double BsiScalarSeconds;
+    double BsiAvx2Seconds;
+};
+
+template <class F>
+double MeasureAverageTime(const std::size_t warmupIterations,
+                          const std::size_t iterations, F&& f)
+{
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        (void)f();
+    }
+
+    return MeasureExecutionTime(iterations, f) / static_cast<double>(iterations);
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+    constexpr float openMaximum = std::numeric_limits<float>::infinity();
+
+    constexpr BalanceQuery queries[] = {
+        {"Balance >= 250", 250.0f, openMaximum},
+        {"Balance >= 900", 900.0f, openMaximum},
+        {"Balance >= 990", 990.0f, openMaximum},
+        {"Balance >= 999", 999.0f, openMaximum},
+        {"100 <= Balance < 900", 100.0f, 900.0f},
+        {"400 <= Balance < 410", 400.0f, 410.0f},
+    };
+
+    std::println("");
+    std::println("[ DoD Bit-Sliced Index Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Balance Slices    : {} (cents)", SliceCount);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    std::println("");
+    std::println("Building index...");
+
+    const BitSlicedIndex index{usersView};
+
+    std::vector<uint32_t> userCents(elementsCount);
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        userCents[i] = ToCents(usersView.Balances[i]);
+    }
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    std::vector<QueryResults> results;
+
+    for (const BalanceQuery& query : queries) {
+        const CentsRange range{
+            ToCents(query.MinimumBalance),
+            query.MaximumBalance == openMaximum
+                ? (uint32_t{1} << SliceCount) : ToCents(query.MaximumBalance),
+        };
+
+        /* The index answers the query on the cents it stores, so the exact
+         * reference is taken on the same fixed-point values. */
+        uint64_t exactCount = 0;
+        uint64_t exactCents = 0;
+        for (std::size_t i = 0; i < elementsCount; ++i) {
+            const bool bMatches = usersView.Active[i]
+                && userCents[i] >= range.MinimumCents
+                && (!range.HasMaximum() || userCents[i] < range.MaximumCents);
+            exactCount += bMatches ? 1u : 0u;
+            exactCents += bMatches ? userCents[i] : 0u;
+        }
+
+        QueryResults queryResults{};
+        queryResults.Name = query.Name;
+        queryResults.Selectivity =
+            static_cast<double>(exactCount) / static_cast<double>(elementsCount);
+        queryResults.ExactChecksum =
+            static_cast<double>(exactCents) / CentsPerUnit;
+
+        BsiAggregate aggregate{};
+
+        queryResults.FloatScalarSeconds = MeasureAverageTime(
+            warmupIterations, iterations, [&] {
+                queryResults.FloatChecksum = SumActiveBalancesRangeScalar(
+                    usersView, query.MinimumBalance, query.MaximumBalance);
+                return queryResults.FloatChecksum;
+            });
+
+        queryResults.BsiScalarSeconds = MeasureAverageTime(
+            warmupIterations, iterations, [&] {
+                aggregate = SumActiveBalancesBsiScalar(index, range);
+                return static_cast<float>(aggregate.SumCents);
+            });
+
+#if defined(__AVX2__)
+        queryResults.FloatAvx2Seconds = MeasureAverageTime(
+            warmupIterations, iterations, [&] {
+                queryResults.FloatChecksum = SumActiveBalancesRangeAvx2(
+                    usersView, query.MinimumBalance, query.MaximumBalance);
+                return queryResults.FloatChecksum;
+            });
+
+        queryResults.BsiAvx2Seconds = MeasureAverageTime(
+            warmupIterations, iterations, [&] {
+                aggregate = SumActiveBalancesBsiAvx2(index, range);
+                return static_cast<float>(aggregate.SumCents);
+            });
+#endif  /* defined(__AVX2__) */
+
+        queryResults.BsiChecksum =
+            static_cast<double>(aggregate.SumCents) / CentsPerUnit;
+        queryResults.bCountMatches =
+            aggregate.Count == exactCount && aggregate.SumCents == exactCents;
+
+        results.push_back(queryResults);
+    }
+
+    const auto nanosecondsPerElement = [&](const double averageTimeSeconds) {
+        return (averageTimeSeconds * 1e9) / static_cast<double>(elementsCount);
+    };
+
+    std::println("");
+    std::println("[ Footprint Results (Bytes per Row) ]");
+    std::println("Float + Byte Flag   : {:.3f}", sizeof(float) + sizeof(uint8_t) * 1.0);
+    std::println("Bit-Sliced + Active : {:.3f}",
+                 static_cast<double>(index.GetSizeBytes())
+                     / static_cast<double>(elementsCount));
+
+    std::println("");
+    std::println("[ Query Results (Nanoseconds per Element) ]");
+    std::println("{:<22} | {:>11} | {:>12} | {:>11} | {:>10} | {:>8}",
+                 "Query", "Selectivity", "Float Scalar", "Float AVX2",
+                 "BSI Scalar", "BSI AVX2");
+
+    for (const QueryResults& queryResults : results) {
+        std::println("{:<22} | {:>10.2f}% | {:>12.3f} | {:>11.3f} | {:>10.3f} | {:>8.3f}",
+                     queryResults.Name, queryResults.Selectivity * 100.0,
+                     nanosecondsPerElement(queryResults.FloatScalarSeconds),
+                     nanosecondsPerElement(queryResults.FloatAvx2Seconds),
+                     nanosecondsPerElement(queryResults.BsiScalarSeconds),
+                     nanosecondsPerElement(queryResults.BsiAvx2Seconds));
+    }
+
+    std::println("");
+    std::println("[ Checksum Results ]");
+    std::println("{:<22} | {:>16} | {:>16} | {:>16} | {:>8}",
+                 "Query", "Float Checksum", "BSI Checksum", "Exact (Cents)",
+                 "BSI");
+
+    for (const QueryResults& queryResults : results) {
+        std::println("{:<22} | {:>16.2f} | {:>16.2f} | {:>16.2f} | {:>8}",
+                     queryResults.Name, queryResults.FloatChecksum,
+                     queryResults.BsiChecksum, queryResults.ExactChecksum,
+                     queryResults.bCountMatches ? "exact" : "MISMATCH");
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/* Adaptive index over a private copy of the Balance/Active columns. Nothing
+ * is built up front: every `Balance >= threshold` query cracks the one piece
+ * that contains its threshold into a `< threshold` and a `>= threshold` part.
+ * The piece map keys each piece by its smallest possible balance, and each
+ * piece caches the sum of its active balances, computed during the same
+ * partitioning pass. The answer is then the sum of the cached aggregates of
+ * the pieces at and above the threshold, so as the pieces shrink a query
+ * touches less and less data. */
+class CrackerIndex
+{
+public:
+    explicit CrackerIndex(const UsersView& usersView)
+        : Balances(usersView.Balances, usersView.Balances + usersView.Count)
+        , Active(usersView.Active, usersView.Active + usersView.Count)
+    {
+        Pieces.emplace(-std::numeric_limits<float>::infinity(), Piece{0, 0.0});
+    }
+
+    float SumActiveBalances(const float minimumBalance)
+    {
+        Crack(minimumBalance);
+
+        double accumulatedBalance = 0.0;
+        for (auto it = Pieces.find(minimumBalance); it != Pieces.end(); ++it) {
+            accumulatedBalance += it->second.ActiveSum;
+        }
+
+        return static_cast<float>(accumulatedBalance);
+    }
+
+    std::size_t GetPiecesCount() const
+    {
+        return Pieces.size();
+    }
+
+private:
+    struct Piece
+    {
+        std::size_t Begin;
+        double ActiveSum;
+    };
+
+    void Crack(const float pivot)
+    {
+        auto piece = std::prev(Pieces.upper_bound(pivot));
+        if (piece->first == pivot) {
+            return;
+        }
+
+        const auto next = std::next(piece);
+        const std::size_t begin = piece->second.Begin;
+        const std::size_t end =
+            next == Pieces.end() ? Balances.size() : next->second.Begin;
+
+        double lowSum = 0.0;
+        double highSum = 0.0;
+        const std::size_t split = Partition(begin, end, pivot, lowSum, highSum);
+
+        piece->second.ActiveSum = lowSum;
+        Pieces.emplace_hint(next, pivot, Piece{split, highSum});
+    }
+
+    /* Hoare-style partition of [begin, end) around `pivot` that also sums the
+     * active balances landing on each side. Returns the first row of the
+     * `>= pivot` side. */
+    std::size_t Partition(const std::size_t begin, const std::size_t end,
+                          const float pivot, double& lowSum, double& highSum)
+    {
+        float* RESTRICT_ALIAS balances = Balances.data();
+        uint8_t* RESTRICT_ALIAS activeFlags = Active.data();
+
+        std::size_t i = begin;
+        std::size_t j = end;
+
+        for (;;) {
+            while (i < j && balances[i] < pivot) {
+                lowSum += activeFlags[i] ? balances[i] : 0.0f;
+                ++i;
+            }
+
+            while (i < j && balances[j - 1] >= pivot) {
+                highSum += activeFlags[j - 1] ? balances[j - 1] : 0.0f;
+                --j;
+            }
+
+            if (i >= j) {
+                return i;
+            }
+
+            std::swap(balances[i], balances[j - 1]);
+            std::swap(activeFlags[i], activeFlags[j - 1]);
+        }
+    }
+
+    AlignedVector<float> Balances;
+    AlignedVector<uint8_t> Active;
+    std::map<float, Piece> Pieces;
+};
+
+/* The up-front alternative: sort a copy by balance once, then keep suffix
+ * sums of the active balances so every query is one binary search. */
+class SortedIndex
+{
+public:
+    explicit SortedIndex(const UsersView& usersView)
+    {
+        std::vector<uint32_t> order(usersView.Count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](const uint32_t l, const uint32_t r) {
+            return usersView.Balances[l] < usersView.Balances[r];
+        });
+
+        Balances.resize(usersView.Count);
+        SuffixSums.resize(usersView.Count + 1);
+        SuffixSums[usersView.Count] = 0.0;
+
+        for (std::size_t i = usersView.Count; i-- > 0;) {
+            const uint32_t row = order[i];
+            Balances[i] = usersView.Balances[row];
+            SuffixSums[i] = SuffixSums[i + 1]
+                + (usersView.Active[row] ? usersView.Balances[row] : 0.0f);
+        }
+    }
+
+    float SumActiveBalances(const float minimumBalance) const
+    {
+        const auto first =
+            std::lower_bound(Balances.begin(), Balances.end(), minimumBalance);
+        return static_cast<float>(
+            SuffixSums[static_cast<std::size_t>(first - Balances.begin())]);
+    }
+
+private:
+    AlignedVector<float> Balances;
+    std::vector<double> SuffixSums;
+};
+
+struct QueryTimes
+{
+    double ScanSeconds;
+    double SortSeconds;
+    double CrackSeconds;
+};
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t queriesCount = 1000;
+    constexpr std::size_t reportedQueries[] = {
+        1, 2, 3, 5, 10, 20, 50, 100, 200, 500, 1000,
+    };
+
+    std::println("");
+    std::println("[ DoD Cracking Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Queries Count     : {}", queriesCount);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    /* Thresholds rounded to cents, so repeats happen as they would with real
+     * dashboard filters. */
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+    std::vector<float> thresholds(queriesCount);
+    for (float& threshold : thresholds) {
+        threshold = std::round(balanceDistribution(randomEngine) * 100.0f) / 100.0f;
+    }
+
+    std::println("");
+    std::println("Running query sequence...");
+
+    std::vector<QueryTimes> queryTimes(queriesCount);
+    double maximumRelativeError = 0.0;
+
+    /* The copies belong to the first query of each strategy: that is when a
+     * system adopting them would pay for it. */
+    std::optional<CrackerIndex> crackerIndex;
+    std::optional<SortedIndex> sortedIndex;
+
+    for (std::size_t q = 0; q < queriesCount; ++q) {
+        const float threshold = thresholds[q];
+
+        float scanChecksum = 0.0f;
+        float sortChecksum = 0.0f;
+        float crackChecksum = 0.0f;
+
+        queryTimes[q].ScanSeconds = MeasureExecutionTime(1, [&] {
+#if defined(__AVX2__)
+            scanChecksum = SumActiveBalancesAvx2(usersView, threshold);
+#else   /* defined(__AVX2__) */
+            scanChecksum = SumActiveBalancesScalar(usersView, threshold);
+#endif  /* defined(__AVX2__) */
+            return scanChecksum;
+        });
+
+        queryTimes[q].SortSeconds = MeasureExecutionTime(1, [&] {
+            if (!sortedIndex) {
+                sortedIndex.emplace(usersView);
+            }
+            sortChecksum = sortedIndex->SumActiveBalances(threshold);
+            return sortChecksum;
+        });
+
+        queryTimes[q].CrackSeconds = MeasureExecutionTime(1, [&] {
+            if (!crackerIndex) {
+                crackerIndex.emplace(usersView);
+            }
+            crackChecksum = crackerIndex->SumActiveBalances(threshold);
+            return crackChecksum;
+        });
+
+        /* The scan accumulates in float; the indexes sum their pieces in
+         * double, so compare them against each other and bound the scan. */
+        const double reference = std::max(1.0, std::abs(double{sortChecksum}));
+        maximumRelativeError = std::max(
+            maximumRelativeError,
+            std::abs(double{crackChecksum} - double{sortChecksum}) / reference);
+        maximumRelativeError = std::max(
+            maximumRelativeError,
+            std::abs(double{scanChecksum} - double{sortChecksum}) / reference);
+    }
+
+    std::println("");
+    std::println("[ Per-Query Latency (Milliseconds) ]");
+    std::println("{:>7} | {:>10} | {:>12} | {:>10} | {:>13} | {:>15} | {:>13}",
+                 "Query", "Scan", "Sort Upfront", "Cracking",
+                 "Scan Total", "Sort Total", "Crack Total");
+
+    double scanTotal = 0.0;
+    double sortTotal = 0.0;
+    double crackTotal = 0.0;
+    std::size_t reported = 0;
+
+    for (std::size_t q = 0; q < queriesCount; ++q) {
+        scanTotal += queryTimes[q].ScanSeconds;
+        sortTotal += queryTimes[q].SortSeconds;
+        crackTotal += queryTimes[q].CrackSeconds;
+
+        if (reported < std::size(reportedQueries)
+            && reportedQueries[reported] == q + 1) {
+            std::println("{:>7} | {:>10.3f} | {:>12.3f} | {:>10.3f} | {:>13.1f} | {:>15.1f} | {:>13.1f}",
+                         q + 1,
+                         queryTimes[q].ScanSeconds * 1e3,
+                         queryTimes[q].SortSeconds * 1e3,
+                         queryTimes[q].CrackSeconds * 1e3,
+                         scanTotal * 1e3, sortTotal * 1e3, crackTotal * 1e3);
+            ++reported;
+        }
+    }
+
+    std::println("");
+    std::println("[ Cracking Results ]");
+    std::println("Pieces after Sequence      : {}", crackerIndex->GetPiecesCount());
+    std::println("Maximum Relative Error     : {:.3e}", maximumRelativeError);
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
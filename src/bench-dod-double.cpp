@@ -4,37 +4,13 @@
 #include <cstdlib>
 #include <print>
 #include <random>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "dod-users.hpp"
 #include "lib.hpp"
 
-struct UsersView
-{
-    const int32_t* RESTRICT_ALIAS Ids;
-    const float* RESTRICT_ALIAS Balances;
-    const uint8_t* RESTRICT_ALIAS Active;
-    std::size_t Count;
-};
-
-FORCE_NOINLINE double SumActiveBalances(
-    const UsersView &usersView, const float minimumBalance)
-{
-    double accumulatedBalance = 0.0;
-    const float thresholdBalance = minimumBalance;
-
-    for (std::size_t i = 0; i < usersView.Count; ++i) {
-        const float balanceValue = usersView.Balances[i];
-        const float takeValue =
-            (usersView.Active[i] && balanceValue >= thresholdBalance)
-                ? 1.0f : 0.0f;
-        accumulatedBalance +=
-            static_cast<double>(balanceValue) * static_cast<double>(takeValue);
-    }
-
-    return accumulatedBalance;
-}
-
 int32_t main()
 {
     constexpr std::size_t elementsCount = 1'000'000'000;
@@ -52,35 +28,21 @@ int32_t main()
     std::println("Iterations        : {}", iterations);
 
     std::mt19937 randomEngine{randomSeed};
-    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
-    std::bernoulli_distribution           activeDistribution{0.6};
 
     std::println("");
     std::println("Generating elements...");
 
-    std::vector<std::int32_t> userIds(elementsCount);
-    std::vector<float> userBalances(elementsCount);
-    std::vector<std::uint8_t> userActiveFlags(elementsCount);
-
-    for (std::size_t i = 0; i < elementsCount; ++i) {
-        userIds[i] = static_cast<std::int32_t>(i);
-        userBalances[i] = balanceDistribution(randomEngine);
-        userActiveFlags[i] = activeDistribution(randomEngine) ? 1u : 0u;
-    }
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
 
-    UsersView usersView{
-        userIds.data(),
-        userBalances.data(),
-        userActiveFlags.data(),
-        elementsCount,
-    };
+    const UsersView usersView = MakeUsersView(users);
 
     std::println("");
     std::println("Warming up...");
 
     double checksum = 0.0;
     for (std::size_t i = 0; i < warmupIterations; ++i) {
-        checksum = SumActiveBalances(usersView, minimumBalance);
+        checksum = SumActiveBalancesScalarDouble(usersView, minimumBalance);
     }
 
     std::println("");
@@ -88,7 +50,7 @@ int32_t main()
 
     const double totalTimeSeconds = MeasureExecutionTime(
         iterations, [&] {
-            return SumActiveBalances(usersView, minimumBalance);
+            return SumActiveBalancesScalarDouble(usersView, minimumBalance);
         });
 
     const double averageTimeSeconds = totalTimeSeconds / iterations;
@@ -0,0 +1,593 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "lib.hpp"
+#include "soa-table.hpp"
+
+/* Piecewise-linear learned index in the style of the PGM-index. Each level is
+ * a list of segments; a segment predicts the position of a key with a line
+ * and is guaranteed to be off by at most Epsilon for every key it was built
+ * from. Level 0 is built over the sorted keys, every level above over the
+ * first keys of the level below, up to a single root segment. A lookup walks
+ * down from the root, each step a bounded search of 2 * Epsilon + 1 slots. */
+template <class Key>
+class PgmIndex
+{
+public:
+    static constexpr std::size_t EpsilonData = 64;
+    static constexpr std::size_t EpsilonInternal = 8;
+
+    explicit PgmIndex(const std::span<const Key> keys)
+        : Keys(keys)
+    {
+        Levels.push_back(BuildSegments(keys, EpsilonData));
+
+        while (Levels.back().size() > 1) {
+            std::vector<Key> firstKeys;
+            firstKeys.reserve(Levels.back().size());
+            for (const Segment& segment : Levels.back()) {
+                firstKeys.push_back(segment.FirstKey);
+            }
+
+            LevelKeys.push_back(std::move(firstKeys));
+            Levels.push_back(BuildSegments(LevelKeys.back(), EpsilonInternal));
+        }
+    }
+
+    /* Position of the first key not less than `key`, as std::lower_bound. */
+    std::size_t LowerBound(const Key key) const
+    {
+        std::size_t segment = 0;
+
+        for (std::size_t level = Levels.size() - 1; level > 0; --level) {
+            const std::span<const Key> keys = LevelKeys[level - 1];
+            const std::size_t position = BoundedLowerBound(
+                keys, Levels[level][segment].Predict(key, keys.size()),
+                EpsilonInternal, key);
+
+            /* The segment covering `key` is the last one starting at or
+             * before it. */
+            segment = position < keys.size() && keys[position] == key
+                ? position : (position == 0 ? 0 : position - 1);
+        }
+
+        return BoundedLowerBound(
+            Keys, Levels[0][segment].Predict(key, Keys.size()), EpsilonData, key);
+    }
+
+    std::size_t GetSegmentsCount() const
+    {
+        return Levels[0].size();
+    }
+
+    std::size_t GetLevelsCount() const
+    {
+        return Levels.size();
+    }
+
+    std::size_t GetSizeBytes() const
+    {
+        std::size_t sizeBytes = 0;
+        for (const std::vector<Segment>& level : Levels) {
+            sizeBytes += level.size() * sizeof(Segment);
+        }
+        for (const std::vector<Key>& keys : LevelKeys) {
+            sizeBytes += keys.size() * sizeof(Key);
+        }
+
+        return sizeBytes;
+    }
+
+private:
+    struct Segment
+    {
+        Key FirstKey;
+        float Slope;
+        int32_t Intercept;
+
+        std::size_t Predict(const Key key, const std::size_t count) const
+        {
+            const double position = static_cast<double>(Intercept)
+                + static_cast<double>(Slope)
+                    * (static_cast<double>(key) - static_cast<double>(FirstKey));
+
+            return static_cast<std::size_t>(
+                std::clamp(position, 0.0, static_cast<double>(count)));
+        }
+    };
+
+    /* Shrinking-cone segmentation: every segment is anchored at its first
+     * key, and the range of slopes that keeps all keys so far within
+     * `epsilon` narrows with each key; when it becomes empty the key starts
+     * a new segment. Duplicates only contribute their first position, which
+     * is where a lower bound lands. */
+    static std::vector<Segment> BuildSegments(const std::span<const Key> keys,
+                                              const std::size_t epsilon)
+    {
+        std::vector<Segment> segments;
+        if (keys.empty()) {
+            segments.push_back(Segment{Key{}, 0.0f, 0});
+            return segments;
+        }
+
+        const double error = static_cast<double>(epsilon);
+
+        double originKey = static_cast<double>(keys[0]);
+        double originPosition = 0.0;
+        double lowSlope = 0.0;
+        double highSlope = std::numeric_limits<double>::infinity();
+        std::size_t segmentBegin = 0;
+
+        const auto closeSegment = [&] {
+            const double slope = std::isinf(highSlope)
+                ? lowSlope : (lowSlope + highSlope) / 2.0;
+            segments.push_back(Segment{
+                keys[segmentBegin], static_cast<float>(slope),
+                static_cast<int32_t>(segmentBegin),
+            });
+        };
+
+        for (std::size_t i = 1; i < keys.size(); ++i) {
+            if (keys[i] == keys[i - 1]) {
+                continue;
+            }
+
+            const double dx = static_cast<double>(keys[i]) - originKey;
+            const double dy = static_cast<double>(i) - originPosition;
+            const double pointLow = (dy - error) / dx;
+            const double pointHigh = (dy + error) / dx;
+
+            if (pointLow > highSlope || pointHigh < lowSlope) {
+                closeSegment();
+
+                segmentBegin = i;
+                originKey = static_cast<double>(keys[i]);
+                originPosition = static_cast<double>(i);
+                lowSlope = 0.0;
+                highSlope = std::numeric_limits<double>::infinity();
+                continue;
+            }
+
+            lowSlope = std::max(lowSlope, pointLow);
+            highSlope = std::min(highSlope, pointHigh);
+        }
+
+        closeSegment();
+
+        return segments;
+    }
+
+    /* Lower bound in a window of +/- `epsilon` around the prediction. Keys
+     * between the segment's build points (or past a long run of duplicates)
+     * can land just outside it, so the window is widened exponentially until
+     * it provably brackets the answer. */
+    static std::size_t BoundedLowerBound(const std::span<const Key> keys,
+                                         const std::size_t predicted,
+                                         const std::size_t epsilon, const Key key)
+    {
+        const std::size_t count = keys.size();
+
+        std::size_t low = predicted > epsilon ? predicted - epsilon : 0;
+        std::size_t high = std::min(count, predicted + epsilon + 2);
+
+        for (std::size_t step = epsilon + 1; low > 0 && !(keys[low - 1] < key); step *= 2) {
+            low = low > step ? low - step : 0;
+        }
+
+        for (std::size_t step = epsilon + 1; high < count && keys[high - 1] < key; step *= 2) {
+            high = std::min(count, high + step);
+        }
+
+        return static_cast<std::size_t>(
+            std::lower_bound(keys.begin() + static_cast<std::ptrdiff_t>(low),
+                             keys.begin() + static_cast<std::ptrdiff_t>(high), key)
+            - keys.begin());
+    }
+
+    std::span<const Key> Keys;
+    std::vector<std::vector<Segment>> Levels;
+    std::vector<std::vector<Key>> LevelKeys;
+};
+
+/* Sorted keys in BFS (Eytzinger) order, with the sorted rank of each slot
+ * alongside. The search is branchless and prefetches four levels ahead. */
+template <class Key>
+class EytzingerIndex
+{
+public:
+    explicit EytzingerIndex(const std::span<const Key> keys)
+        : Keys(keys.size() + 1)
+        , Ranks(keys.size() + 1)
+    {
+        std::size_t next = 0;
+        Build(keys, 1, next);
+    }
+
+    std::size_t LowerBound(const Key key) const
+    {
+        const std::size_t count = Keys.size() - 1;
+        const Key* RESTRICT_ALIAS keys = Keys.data();
+
+        std::size_t k = 1;
+        while (k <= count) {
+            __builtin_prefetch(keys + k * 16);
+            k = 2 * k + (keys[k] < key ? 1 : 0);
+        }
+
+        k >>= std::countr_one(k) + 1;
+
+        return k == 0 ? count : Ranks[k];
+    }
+
+    std::size_t GetSizeBytes() const
+    {
+        return Keys.size() * sizeof(Key) + Ranks.size() * sizeof(uint32_t);
+    }
+
+private:
+    void Build(const std::span<const Key> keys, const std::size_t k,
+               std::size_t& next)
+    {
+        if (k > keys.size()) {
+            return;
+        }
+
+        Build(keys, 2 * k, next);
+        Keys[k] = keys[next];
+        Ranks[k] = static_cast<uint32_t>(next);
+        ++next;
+        Build(keys, 2 * k + 1, next);
+    }
+
+    AlignedVector<Key> Keys;
+    std::vector<uint32_t> Ranks;
+};
+
+/* Static B-tree with 16 keys per 64-byte node in an implicit layout (child i
+ * of node k is node k * 17 + i + 1), searched with one SIMD compare per
+ * node. */
+template <class Key>
+class StaticBTreeIndex
+{
+public:
+    static constexpr std::size_t NodeKeys = 16;
+
+    explicit StaticBTreeIndex(const std::span<const Key> keys)
+        : NodesCount((keys.size() + NodeKeys - 1) / NodeKeys)
+        , Keys(NodesCount * NodeKeys)
+        , Ranks(NodesCount * NodeKeys)
+        , Count(keys.size())
+    {
+        std::size_t next = 0;
+        Build(keys, 0, next);
+    }
+
+    std::size_t LowerBound(const Key key) const
+    {
+        std::size_t result = Count;
+        std::size_t k = 0;
+
+        while (k < NodesCount) {
+            const std::size_t i = CountLess(Keys.data() + k * NodeKeys, key);
+            if (i < NodeKeys) {
+                result = Ranks[k * NodeKeys + i];
+            }
+            k = k * (NodeKeys + 1) + i + 1;
+        }
+
+        return result;
+    }
+
+    std::size_t GetSizeBytes() const
+    {
+        return Keys.size() * sizeof(Key) + Ranks.size() * sizeof(uint32_t);
+    }
+
+private:
+    static std::size_t CountLess(const Key* RESTRICT_ALIAS node, const Key key)
+    {
+#if defined(__AVX2__)
+        if constexpr (std::is_same_v<Key, float>) {
+            const __m256 x = _mm256_set1_ps(key);
+            const int low = _mm256_movemask_ps(
+                _mm256_cmp_ps(_mm256_load_ps(node), x, _CMP_LT_OQ));
+            const int high = _mm256_movemask_ps(
+                _mm256_cmp_ps(_mm256_load_ps(node + 8), x, _CMP_LT_OQ));
+            return static_cast<std::size_t>(std::popcount(
+                static_cast<uint32_t>(low | (high << 8))));
+        } else if constexpr (std::is_same_v<Key, int32_t>) {
+            const __m256i x = _mm256_set1_epi32(key);
+            const int low = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(
+                x, _mm256_load_si256(reinterpret_cast<const __m256i*>(node)))));
+            const int high = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(
+                x, _mm256_load_si256(reinterpret_cast<const __m256i*>(node + 8)))));
+            return static_cast<std::size_t>(std::popcount(
+                static_cast<uint32_t>(low | (high << 8))));
+        }
+#endif  /* defined(__AVX2__) */
+
+        std::size_t less = 0;
+        for (std::size_t i = 0; i < NodeKeys; ++i) {
+            less += node[i] < key ? 1u : 0u;
+        }
+
+        return less;
+    }
+
+    /* In-order fill: keys past the end are padded with the largest value
+     * and rank `Count`, so they never compare less. */
+    void Build(const std::span<const Key> keys, const std::size_t k,
+               std::size_t& next)
+    {
+        if (k >= NodesCount) {
+            return;
+        }
+
+        for (std::size_t i = 0; i < NodeKeys; ++i) {
+            Build(keys, k * (NodeKeys + 1) + i + 1, next);
+
+            const bool bHasKey = next < keys.size();
+            Keys[k * NodeKeys + i] =
+                bHasKey ? keys[next] : std::numeric_limits<Key>::max();
+            Ranks[k * NodeKeys + i] = static_cast<uint32_t>(bHasKey ? next : Count);
+            next += bHasKey ? 1 : 0;
+        }
+
+        Build(keys, k * (NodeKeys + 1) + NodeKeys + 1, next);
+    }
+
+    std::size_t NodesCount;
+    AlignedVector<Key> Keys;
+    std::vector<uint32_t> Ranks;
+    std::size_t Count;
+};
+
+template <class Key>
+class SortedArrayIndex
+{
+public:
+    explicit SortedArrayIndex(const std::span<const Key> keys)
+        : Keys(keys)
+    {
+    }
+
+    std::size_t LowerBound(const Key key) const
+    {
+        return static_cast<std::size_t>(
+            std::lower_bound(Keys.begin(), Keys.end(), key) - Keys.begin());
+    }
+
+    std::size_t GetSizeBytes() const
+    {
+        return 0;
+    }
+
+private:
+    std::span<const Key> Keys;
+};
+
+/* Point lookups only: a hash map has no order to answer a lower bound. */
+class HashIndex
+{
+public:
+    explicit HashIndex(const std::span<const int32_t> keys)
+    {
+        Rows.reserve(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            Rows.emplace(keys[i], static_cast<uint32_t>(i));
+        }
+    }
+
+    std::size_t LowerBound(const int32_t key) const
+    {
+        const auto it = Rows.find(key);
+        return it == Rows.end() ? 0 : it->second;
+    }
+
+    /* Nodes, plus one bucket pointer per bucket. */
+    std::size_t GetSizeBytes() const
+    {
+        return Rows.size() * (sizeof(std::pair<const int32_t, uint32_t>) + sizeof(void*))
+            + Rows.bucket_count() * sizeof(void*);
+    }
+
+private:
+    std::unordered_map<int32_t, uint32_t> Rows;
+};
+
+struct IndexResults
+{
+    std::size_t SizeBytes;
+    std::size_t Checksum;
+    double NanosecondsPerLookup;
+};
+
+template <class Index, class Key>
+FORCE_NOINLINE IndexResults BenchmarkLookups(const Index& index,
+                                             const std::span<const Key> probes,
+                                             const std::size_t iterations)
+{
+    std::size_t checksum = 0;
+
+    const double totalTimeSeconds = MeasureExecutionTime(iterations, [&] {
+        checksum = 0;
+        for (const Key probe : probes) {
+            checksum += index.LowerBound(probe);
+        }
+        return static_cast<float>(checksum);
+    });
+
+    return IndexResults{
+        index.GetSizeBytes(), checksum,
+        totalTimeSeconds * 1e9
+            / static_cast<double>(iterations * probes.size()),
+    };
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t iterations = 4;
+    constexpr std::size_t lookupsCount = 1'000'000;
+    constexpr double deletedRate = 0.05;
+
+    std::println("");
+    std::println("[ Learned Index Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Iterations        : {}", iterations);
+    std::println("Lookups Count     : {}", lookupsCount);
+    std::println("Deleted Id Rate   : {:.2f} %", deletedRate * 100.0);
+    std::println("PGM Epsilon       : {} (data), {} (internal)",
+                 PgmIndex<float>::EpsilonData, PgmIndex<float>::EpsilonInternal);
+
+    std::mt19937 randomEngine{randomSeed};
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+    std::bernoulli_distribution           deletedDistribution{deletedRate};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    /* Near-dense ids: issued sequentially, with a share of the users since
+     * deleted. */
+    AlignedVector<int32_t> sortedIds;
+    sortedIds.reserve(elementsCount);
+    for (int32_t id = 0; sortedIds.size() < elementsCount; ++id) {
+        if (!deletedDistribution(randomEngine)) {
+            sortedIds.push_back(id);
+        }
+    }
+
+    AlignedVector<float> sortedBalances(elementsCount);
+    for (float& balance : sortedBalances) {
+        balance = balanceDistribution(randomEngine);
+    }
+    std::sort(sortedBalances.begin(), sortedBalances.end());
+
+    std::uniform_int_distribution<std::size_t> rowDistribution{
+        0, elementsCount - 1
+    };
+
+    std::vector<int32_t> idProbes(lookupsCount);
+    for (int32_t& probe : idProbes) {
+        probe = sortedIds[rowDistribution(randomEngine)];
+    }
+
+    std::vector<float> balanceProbes(lookupsCount);
+    for (float& probe : balanceProbes) {
+        probe = balanceDistribution(randomEngine);
+    }
+
+    std::println("");
+    std::println("Building indexes...");
+
+    const std::span<const int32_t> ids{sortedIds};
+    const std::span<const float> balances{sortedBalances};
+
+    const PgmIndex<int32_t> idsPgm{ids};
+    const PgmIndex<float> balancesPgm{balances};
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    struct StructureResults
+    {
+        const char* Name;
+        IndexResults Ids;
+        IndexResults Balances;
+        bool bHasBalances;
+    };
+
+    const std::span<const int32_t> idProbesSpan{idProbes};
+    const std::span<const float> balanceProbesSpan{balanceProbes};
+
+    std::vector<StructureResults> results;
+
+    results.push_back(StructureResults{
+        "std::lower_bound",
+        BenchmarkLookups(SortedArrayIndex<int32_t>{ids}, idProbesSpan, iterations),
+        BenchmarkLookups(SortedArrayIndex<float>{balances}, balanceProbesSpan, iterations),
+        true,
+    });
+    results.push_back(StructureResults{
+        "Eytzinger",
+        BenchmarkLookups(EytzingerIndex<int32_t>{ids}, idProbesSpan, iterations),
+        BenchmarkLookups(EytzingerIndex<float>{balances}, balanceProbesSpan, iterations),
+        true,
+    });
+    results.push_back(StructureResults{
+        "Static B-Tree (16)",
+        BenchmarkLookups(StaticBTreeIndex<int32_t>{ids}, idProbesSpan, iterations),
+        BenchmarkLookups(StaticBTreeIndex<float>{balances}, balanceProbesSpan, iterations),
+        true,
+    });
+    results.push_back(StructureResults{
+        "std::unordered_map",
+        BenchmarkLookups(HashIndex{ids}, idProbesSpan, iterations),
+        IndexResults{},
+        false,
+    });
+    results.push_back(StructureResults{
+        "PGM (Learned)",
+        BenchmarkLookups(idsPgm, idProbesSpan, iterations),
+        BenchmarkLookups(balancesPgm, balanceProbesSpan, iterations),
+        true,
+    });
+
+    std::println("");
+    std::println("[ Learned Index Shape ]");
+    std::println("Id Segments                : {}", idsPgm.GetSegmentsCount());
+    std::println("Id Levels                  : {}", idsPgm.GetLevelsCount());
+    std::println("Balance Segments           : {}", balancesPgm.GetSegmentsCount());
+    std::println("Balance Levels             : {}", balancesPgm.GetLevelsCount());
+
+    /* Extra bytes are on top of the sorted key array, which the binary
+     * search and the learned index search in place; the Eytzinger and
+     * B-tree layouts carry their own copy of the keys plus sorted ranks. */
+    std::println("");
+    std::println("[ Lookup Results ]");
+    std::println("{:<20} | {:>16} | {:>10} | {:>9} | {:>16} | {:>10} | {:>9}",
+                 "Structure", "Id Extra Bytes", "Id ns", "Id Match",
+                 "Bal Extra Bytes", "Bal ns", "Bal Match");
+
+    const IndexResults& reference = results.front().Ids;
+    const IndexResults& balanceReference = results.front().Balances;
+
+    for (const StructureResults& structure : results) {
+        if (structure.bHasBalances) {
+            std::println("{:<20} | {:>16} | {:>10.2f} | {:>9} | {:>16} | {:>10.2f} | {:>9}",
+                         structure.Name, structure.Ids.SizeBytes,
+                         structure.Ids.NanosecondsPerLookup,
+                         structure.Ids.Checksum == reference.Checksum ? "match" : "MISMATCH",
+                         structure.Balances.SizeBytes,
+                         structure.Balances.NanosecondsPerLookup,
+                         structure.Balances.Checksum == balanceReference.Checksum
+                             ? "match" : "MISMATCH");
+        } else {
+            std::println("{:<20} | {:>16} | {:>10.2f} | {:>9} | {:>16} | {:>10} | {:>9}",
+                         structure.Name, structure.Ids.SizeBytes,
+                         structure.Ids.NanosecondsPerLookup,
+                         structure.Ids.Checksum == reference.Checksum ? "match" : "MISMATCH",
+                         "n/a", "n/a", "n/a");
+        }
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
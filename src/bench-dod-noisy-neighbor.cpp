@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/*******************************************************************************
+* Bandwidth hogs
+*******************************************************************************/
+
+enum class EHogMode : uint8_t
+{
+    Read,
+    Write,
+};
+
+/* Background threads that stream through private buffers much larger than
+ * an L3 slice, so every byte they move goes to DRAM. Intensity is a duty
+ * cycle: in each period a hog streams for `intensity` of the period and
+ * sleeps for the rest, so 0 leaves the memory controller alone and 1 keeps
+ * it as busy as one core can. Reads are plain vector loads; writes are
+ * non-temporal stores, the pattern of a bulk copy or a log writer. */
+class NoisyNeighbors
+{
+public:
+    static constexpr std::size_t ChunkBytes = 64 * 1024;
+    static constexpr std::chrono::microseconds DutyPeriod{1'000};
+
+    NoisyNeighbors(const std::size_t hogsCount, const std::size_t bufferBytes,
+                   const EHogMode mode)
+        : Mode(mode)
+        , Buffers(hogsCount)
+        , BytesMoved(hogsCount)
+    {
+        for (AlignedVector<float>& buffer : Buffers) {
+            buffer.assign(bufferBytes / sizeof(float), 1.0f);
+        }
+
+        Hogs.reserve(hogsCount);
+        for (std::size_t hog = 0; hog < hogsCount; ++hog) {
+            Hogs.emplace_back([this, hog] { HogLoop(hog); });
+        }
+    }
+
+    ~NoisyNeighbors()
+    {
+        bStopping.store(true, std::memory_order_relaxed);
+        for (std::thread& hog : Hogs) {
+            hog.join();
+        }
+    }
+
+    NoisyNeighbors(const NoisyNeighbors&) = delete;
+    NoisyNeighbors& operator=(const NoisyNeighbors&) = delete;
+
+    void SetIntensity(const double intensity)
+    {
+        IntensityPermille.store(static_cast<uint32_t>(intensity * 1000.0),
+                                std::memory_order_relaxed);
+    }
+
+    uint64_t GetBytesMoved() const
+    {
+        uint64_t bytes = 0;
+        for (const Counter& counter : BytesMoved) {
+            bytes += counter.Value.load(std::memory_order_relaxed);
+        }
+
+        return bytes;
+    }
+
+private:
+    struct Counter
+    {
+        alignas(64) std::atomic<uint64_t> Value{0};
+    };
+
+    void HogLoop(const std::size_t hog)
+    {
+        AlignedVector<float>& buffer = Buffers[hog];
+        const std::size_t chunkFloats = ChunkBytes / sizeof(float);
+        const std::size_t chunksCount = buffer.size() / chunkFloats;
+
+        std::size_t chunk = 0;
+        float sink = 0.0f;
+
+        while (!bStopping.load(std::memory_order_relaxed)) {
+            const std::chrono::time_point<std::chrono::steady_clock> periodStart{
+                std::chrono::steady_clock::now()
+            };
+            const uint32_t permille = IntensityPermille.load(std::memory_order_relaxed);
+            const std::chrono::time_point<std::chrono::steady_clock> busyUntil =
+                periodStart + DutyPeriod * permille / 1000;
+
+            while (permille > 0 && std::chrono::steady_clock::now() < busyUntil) {
+                float* RESTRICT_ALIAS data = buffer.data() + chunk * chunkFloats;
+                if (Mode == EHogMode::Read) {
+                    sink += StreamRead(data, chunkFloats);
+                } else {
+                    StreamWrite(data, chunkFloats, sink);
+                }
+
+                BytesMoved[hog].Value.fetch_add(ChunkBytes, std::memory_order_relaxed);
+                chunk = chunk + 1 == chunksCount ? 0 : chunk + 1;
+            }
+
+            if (permille < 1000) {
+                std::this_thread::sleep_until(periodStart + DutyPeriod);
+            }
+        }
+
+        Sink.store(sink, std::memory_order_relaxed);
+    }
+
+    static float StreamRead(const float* RESTRICT_ALIAS data, const std::size_t count)
+    {
+#if defined(__AVX2__)
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        for (std::size_t i = 0; i < count; i += 16) {
+            acc0 = _mm256_add_ps(acc0, _mm256_load_ps(data + i));
+            acc1 = _mm256_add_ps(acc1, _mm256_load_ps(data + i + 8));
+        }
+
+        __m256 acc = _mm256_add_ps(acc0, acc1);
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        sum = _mm_hadd_ps(sum, sum);
+        sum = _mm_hadd_ps(sum, sum);
+        return _mm_cvtss_f32(sum);
+#else   /* defined(__AVX2__) */
+        float sum = 0.0f;
+        for (std::size_t i = 0; i < count; ++i) {
+            sum += data[i];
+        }
+        return sum;
+#endif  /* defined(__AVX2__) */
+    }
+
+    static void StreamWrite(float* RESTRICT_ALIAS data, const std::size_t count,
+                            const float value)
+    {
+#if defined(__AVX2__)
+        const __m256 v = _mm256_set1_ps(value);
+        for (std::size_t i = 0; i < count; i += 8) {
+            _mm256_stream_ps(data + i, v);
+        }
+        _mm_sfence();
+#else   /* defined(__AVX2__) */
+        std::fill_n(data, count, value);
+#endif  /* defined(__AVX2__) */
+    }
+
+    EHogMode Mode;
+    std::vector<AlignedVector<float>> Buffers;
+    std::vector<Counter> BytesMoved;
+    std::vector<std::thread> Hogs;
+    std::atomic<uint32_t> IntensityPermille{0};
+    std::atomic<bool> bStopping{false};
+    std::atomic<float> Sink{0.0f};
+};
+
+/*******************************************************************************
+* Measurement
+*******************************************************************************/
+
+struct KernelVariant
+{
+    const char* Name;
+    SumActiveBalancesFn Kernel;
+};
+
+struct ContentionResults
+{
+    EHogMode Mode;
+    double Intensity;
+    const char* Kernel;
+    float Checksum;
+    double MeanMilliseconds;
+    double P99Milliseconds;
+    double HogGigabytesPerSecond;
+};
+
+double Percentile(std::vector<double>& samples, const double fraction)
+{
+    const std::size_t index = static_cast<std::size_t>(
+        fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    /* Enough timed scans per cell that P99 lies inside the sample rather
+     * than at its second-largest value. */
+    constexpr std::size_t iterations = 256;
+    constexpr std::size_t hogBufferBytes = 32 * 1024 * 1024;
+    constexpr std::array<double, 5> intensities{0.0, 0.25, 0.5, 0.75, 1.0};
+
+    /* The scan keeps one core; the hogs get the rest up to half the
+     * hardware threads, so they compete for memory rather than for CPU. */
+    const std::size_t hardwareThreads =
+        std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    const std::size_t hogsCount = std::max<std::size_t>(1, hardwareThreads / 2);
+
+    std::println("");
+    std::println("[ DoD Noisy Neighbor Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Bandwidth Hogs    : {}", hogsCount);
+    std::println("Hog Buffer        : {} MiB", hogBufferBytes / (1024 * 1024));
+    std::println("Hog Duty Period   : {} us", NoisyNeighbors::DutyPeriod.count());
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    std::vector<KernelVariant> kernels{
+        {"Scalar", SumActiveBalancesScalar},
+#if defined(__AVX2__)
+        {"AVX2", SumActiveBalancesAvx2},
+        {"Znver2", SumActiveBalancesZnver2},
+#endif  /* defined(__AVX2__) */
+    };
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    std::vector<ContentionResults> results;
+    std::vector<double> samples;
+
+    for (const EHogMode mode : {EHogMode::Read, EHogMode::Write}) {
+        NoisyNeighbors neighbors{hogsCount, hogBufferBytes, mode};
+
+        for (const double intensity : intensities) {
+            neighbors.SetIntensity(intensity);
+
+            for (const KernelVariant& kernel : kernels) {
+                float checksum = 0.0f;
+                for (std::size_t i = 0; i < warmupIterations; ++i) {
+                    checksum = kernel.Kernel(usersView, minimumBalance);
+                }
+
+                samples.clear();
+                const uint64_t hogBytesBefore = neighbors.GetBytesMoved();
+                const std::chrono::time_point<std::chrono::steady_clock> runStart{
+                    std::chrono::steady_clock::now()
+                };
+
+                for (std::size_t i = 0; i < iterations; ++i) {
+                    const std::chrono::time_point<std::chrono::steady_clock> start{
+                        std::chrono::steady_clock::now()
+                    };
+
+                    checksum = kernel.Kernel(usersView, minimumBalance);
+
+                    const std::chrono::time_point<std::chrono::steady_clock> end{
+                        std::chrono::steady_clock::now()
+                    };
+                    samples.push_back(
+                        std::chrono::duration<double, std::milli>(end - start).count());
+                }
+
+                const double runSeconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - runStart).count();
+                const uint64_t hogBytes = neighbors.GetBytesMoved() - hogBytesBefore;
+
+                double totalMilliseconds = 0.0;
+                for (const double sample : samples) {
+                    totalMilliseconds += sample;
+                }
+
+                results.push_back(ContentionResults{
+                    mode, intensity, kernel.Name, checksum,
+                    totalMilliseconds / static_cast<double>(iterations),
+                    Percentile(samples, 0.99),
+                    static_cast<double>(hogBytes) / runSeconds / 1e9,
+                });
+            }
+        }
+    }
+
+    /* "Kept" is each kernel's throughput as a share of its own throughput
+     * with the hogs idle, which is the degradation curve per kernel. */
+    constexpr double bytesPerUser = sizeof(float) + sizeof(uint8_t);
+
+    std::println("");
+    std::println("[ Contention Results ]");
+    std::println("{:<5} | {:>9} | {:<7} | {:>10} | {:>20} | {:>10} | {:>10} | {:>10} | {:>8}",
+                 "Hogs", "Intensity", "Kernel", "Hog GB/s", "Checksum",
+                 "Mean (ms)", "P99 (ms)", "GB/s", "Kept");
+
+    for (const ContentionResults& result : results) {
+        const auto baseline = std::find_if(
+            results.begin(), results.end(), [&](const ContentionResults& candidate) {
+                return candidate.Mode == result.Mode && candidate.Intensity == 0.0
+                    && std::string{candidate.Kernel} == result.Kernel;
+            });
+
+        std::println("{:<5} | {:>7.0f} % | {:<7} | {:>10.2f} | {:>20.2f} | {:>10.2f} | {:>10.2f} | {:>10.2f} | {:>6.1f} %",
+                     result.Mode == EHogMode::Read ? "Read" : "Write",
+                     result.Intensity * 100.0, result.Kernel,
+                     result.HogGigabytesPerSecond, result.Checksum,
+                     result.MeanMilliseconds, result.P99Milliseconds,
+                     static_cast<double>(elementsCount) * bytesPerUser
+                         / (result.MeanMilliseconds * 1e6),
+                     100.0 * baseline->MeanMilliseconds / result.MeanMilliseconds);
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
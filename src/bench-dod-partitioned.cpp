@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/* Users physically partitioned by their active flag: rows [0, ActiveCount)
+ * are the active segment and the rest the inactive one, so the flag is
+ * implied by the row and is not stored. Rows move, ids do not: `RowOfId`
+ * maps an id to its current row and the Id column maps back. Flipping a
+ * user swaps it with the row at the segment boundary and moves the
+ * boundary by one, keeping both segments contiguous. */
+class PartitionedUsersTable
+{
+public:
+    struct Schema
+    {
+        SOA_FIELD(Id, int32_t);
+        SOA_FIELD(Balance, float);
+
+        using Fields = SoaFieldList<Id, Balance>;
+    };
+
+    explicit PartitionedUsersTable(const UsersView& usersView)
+    {
+        Rows.Resize(usersView.Count);
+        RowOfId.resize(usersView.Count);
+
+        const std::span<int32_t> ids = Rows.Column<Schema::Id>();
+        const std::span<float> balances = Rows.Column<Schema::Balance>();
+
+        /* Two passes keep each segment in id order after the build. */
+        std::size_t row = 0;
+        for (const bool bActivePass : {true, false}) {
+            for (std::size_t i = 0; i < usersView.Count; ++i) {
+                if ((usersView.Active[i] != 0) != bActivePass) {
+                    continue;
+                }
+
+                ids[row] = usersView.Ids[i];
+                balances[row] = usersView.Balances[i];
+                RowOfId[static_cast<std::size_t>(usersView.Ids[i])] =
+                    static_cast<uint32_t>(row);
+                ++row;
+            }
+
+            if (bActivePass) {
+                ActiveCount = row;
+            }
+        }
+    }
+
+    std::size_t Size() const
+    {
+        return Rows.Size();
+    }
+
+    std::size_t GetActiveCount() const
+    {
+        return ActiveCount;
+    }
+
+    std::span<const float> GetActiveBalances() const
+    {
+        return Rows.Column<Schema::Balance>().first(ActiveCount);
+    }
+
+    bool IsActive(const int32_t id) const
+    {
+        return RowOfId[static_cast<std::size_t>(id)] < ActiveCount;
+    }
+
+    float GetBalance(const int32_t id) const
+    {
+        return Rows.Column<Schema::Balance>()[RowOfId[static_cast<std::size_t>(id)]];
+    }
+
+    void SetBalance(const int32_t id, const float balance)
+    {
+        Rows.Column<Schema::Balance>()[RowOfId[static_cast<std::size_t>(id)]] =
+            balance;
+    }
+
+    /* Returns whether the user actually changed segment. */
+    bool SetActive(const int32_t id, const bool bActive)
+    {
+        const std::size_t row = RowOfId[static_cast<std::size_t>(id)];
+        const bool bWasActive = row < ActiveCount;
+
+        if (bWasActive == bActive) {
+            return false;
+        }
+
+        if (bActive) {
+            SwapRows(row, ActiveCount);
+            ++ActiveCount;
+        } else {
+            --ActiveCount;
+            SwapRows(row, ActiveCount);
+        }
+
+        return true;
+    }
+
+private:
+    void SwapRows(const std::size_t left, const std::size_t right)
+    {
+        if (left == right) {
+            return;
+        }
+
+        const std::span<int32_t> ids = Rows.Column<Schema::Id>();
+        const std::span<float> balances = Rows.Column<Schema::Balance>();
+
+        std::swap(ids[left], ids[right]);
+        std::swap(balances[left], balances[right]);
+
+        RowOfId[static_cast<std::size_t>(ids[left])] = static_cast<uint32_t>(left);
+        RowOfId[static_cast<std::size_t>(ids[right])] = static_cast<uint32_t>(right);
+    }
+
+    SoaTable<Schema> Rows;
+    std::vector<uint32_t> RowOfId;
+    std::size_t ActiveCount = 0;
+};
+
+FORCE_NOINLINE float SumActiveBalancesPartitionedScalar(
+    const std::span<const float> activeBalances, const float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    for (const float balanceValue : activeBalances) {
+        const float takeValue = balanceValue >= minimumBalance ? 1.0f : 0.0f;
+        accumulatedBalance += balanceValue * takeValue;
+    }
+
+    return accumulatedBalance;
+}
+
+#if defined(__AVX2__)
+/* The active segment needs the threshold compare only: no flag stream, and
+ * no inactive rows to read and discard. */
+FORCE_NOINLINE float SumActiveBalancesPartitionedAvx2(
+    const std::span<const float> activeBalances, float minimumBalance)
+{
+    const std::size_t count = activeBalances.size();
+    const float* RESTRICT_ALIAS balances = activeBalances.data();
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+
+    __m256 acc = _mm256_setzero_ps();
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n8; i += vectorWidth) {
+        __m256 b = _mm256_loadu_ps(&balances[i]);
+        __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
+
+        acc = _mm256_add_ps(acc, _mm256_and_ps(b, cmpMask));
+    }
+
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    float accumulatedBalance = _mm_cvtss_f32(sum);
+
+    for (; i < count; ++i) {
+        if (balances[i] >= minimumBalance) {
+            accumulatedBalance += balances[i];
+        }
+    }
+
+    return accumulatedBalance;
+}
+#endif  /* defined(__AVX2__) */
+
+struct VariantResults
+{
+    const char* Name;
+    double BytesPerUser;
+    float Checksum;
+    double AverageTimeSeconds;
+};
+
+template <class F>
+VariantResults MeasureVariant(const char* name, const double bytesPerUser,
+                              const std::size_t warmupIterations,
+                              const std::size_t iterations, F&& f)
+{
+    VariantResults results{name, bytesPerUser, 0.0f, 0.0};
+
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        results.Checksum = f();
+    }
+
+    results.AverageTimeSeconds =
+        MeasureExecutionTime(iterations, f) / static_cast<double>(iterations);
+
+    return results;
+}
+
+struct ActivityChange
+{
+    int32_t Id;
+    bool bActive;
+};
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+    constexpr std::size_t churnCount = 10'000'000;
+
+    std::println("");
+    std::println("[ DoD Partitioned Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Churn Changes     : {}", churnCount);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const std::span<float> userBalances = users.Column<UserSchema::Balance>();
+    const std::span<std::uint8_t> userActiveFlags =
+        users.Column<UserSchema::Active>();
+
+    const UsersView usersView = MakeUsersView(users);
+
+    std::println("");
+    std::println("Partitioning...");
+
+    PartitionedUsersTable partitioned{usersView};
+
+    std::println("");
+    std::println("Benchmarking scans...");
+
+    const auto benchmarkScans = [&] {
+        /* Every scanned row of the partitioned table is a 4-byte balance, and
+         * only the active share of the rows is scanned; churn moves that
+         * share, so it is taken per run. */
+        const double activeShare = static_cast<double>(partitioned.GetActiveCount())
+            / static_cast<double>(elementsCount);
+
+        return std::vector<VariantResults>{
+            MeasureVariant("Flag Column Scalar", 5.0,
+                           warmupIterations, iterations, [&] {
+                return SumActiveBalancesScalar(usersView, minimumBalance);
+            }),
+            MeasureVariant("Partitioned Scalar", 4.0 * activeShare,
+                           warmupIterations, iterations, [&] {
+                return SumActiveBalancesPartitionedScalar(
+                    partitioned.GetActiveBalances(), minimumBalance);
+            }),
+#if defined(__AVX2__)
+            MeasureVariant("Flag Column AVX2", 5.0,
+                           warmupIterations, iterations, [&] {
+                return SumActiveBalancesAvx2(usersView, minimumBalance);
+            }),
+            MeasureVariant("Partitioned AVX2", 4.0 * activeShare,
+                           warmupIterations, iterations, [&] {
+                return SumActiveBalancesPartitionedAvx2(
+                    partitioned.GetActiveBalances(), minimumBalance);
+            }),
+#endif  /* defined(__AVX2__) */
+        };
+    };
+
+    const std::vector<VariantResults> initialVariants = benchmarkScans();
+
+    std::println("Benchmarking churn...");
+
+    /* Activations and deactivations at the ~60/40 balance of the data set,
+     * so the segment sizes stay stable while rows keep moving. */
+    std::uniform_int_distribution<int32_t> idDistribution{
+        0, static_cast<int32_t>(elementsCount - 1)
+    };
+    std::bernoulli_distribution activeDistribution{0.6};
+
+    std::vector<ActivityChange> changes(churnCount);
+    for (ActivityChange& change : changes) {
+        change.Id = idDistribution(randomEngine);
+        change.bActive = activeDistribution(randomEngine);
+    }
+
+    const double flagChurnSeconds = MeasureExecutionTime(1, [&] {
+        for (const ActivityChange& change : changes) {
+            userActiveFlags[static_cast<std::size_t>(change.Id)] =
+                change.bActive ? 1u : 0u;
+        }
+        return static_cast<float>(userActiveFlags[0]);
+    });
+
+    std::size_t movesCount = 0;
+    const double partitionChurnSeconds = MeasureExecutionTime(1, [&] {
+        for (const ActivityChange& change : changes) {
+            movesCount += partitioned.SetActive(change.Id, change.bActive) ? 1 : 0;
+        }
+        return static_cast<float>(movesCount);
+    });
+
+    std::size_t remapMismatches = 0;
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        const int32_t id = static_cast<int32_t>(i);
+        const bool bMatches = partitioned.IsActive(id) == (userActiveFlags[i] != 0)
+            && partitioned.GetBalance(id) == userBalances[i];
+        remapMismatches += bMatches ? 0u : 1u;
+    }
+
+    std::println("Benchmarking scans after churn...");
+
+    const std::vector<VariantResults> churnedVariants = benchmarkScans();
+
+    const auto printVariants = [&](const char* title,
+                                   const std::vector<VariantResults>& variants) {
+        std::println("");
+        std::println("[ {} ]", title);
+        std::println("{:<20} | {:>10} | {:>20} | {:>16}",
+                     "Variant", "Bytes/User", "Checksum", "ns per Element");
+
+        for (const VariantResults& variant : variants) {
+            std::println("{:<20} | {:>10.2f} | {:>20.2f} | {:>16.2f}",
+                         variant.Name, variant.BytesPerUser, variant.Checksum,
+                         (variant.AverageTimeSeconds * 1e9)
+                             / static_cast<double>(elementsCount));
+        }
+    };
+
+    printVariants("Scan Results", initialVariants);
+    printVariants("Scan Results after Churn", churnedVariants);
+
+    std::println("");
+    std::println("[ Churn Results ]");
+    std::println("Active Users after Churn   : {}", partitioned.GetActiveCount());
+    std::println("Segment Moves              : {}", movesCount);
+    std::println("Remap Mismatches           : {}", remapMismatches);
+    std::println("Flag Write per Change      : {:.2f} ns",
+                 flagChurnSeconds * 1e9 / static_cast<double>(churnCount));
+    std::println("Partition Move per Change  : {:.2f} ns",
+                 partitionChurnSeconds * 1e9 / static_cast<double>(churnCount));
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,633 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+constexpr std::size_t BlockRows = 65'536;
+constexpr std::size_t BlockWords = BlockRows / 64;
+constexpr std::size_t RowBytes = sizeof(float) + sizeof(uint8_t);
+
+/* The users table plus a version per block of `BlockRows` rows. Every write
+ * bumps the version of the block it lands in, which is all the predicate cache
+ * needs to invalidate per dirty block instead of per table. */
+struct VersionedUsersTable
+{
+    UsersTable Users;
+    std::vector<uint64_t> BlockVersions;
+    uint64_t DataVersion = 0;
+
+    std::size_t Count() const
+    {
+        return Users.Size();
+    }
+
+    std::size_t BlocksCount() const
+    {
+        return (Count() + BlockRows - 1) / BlockRows;
+    }
+
+    std::size_t BlockCount(const std::size_t block) const
+    {
+        return std::min(BlockRows, Count() - block * BlockRows);
+    }
+
+    UsersView Block(const std::size_t block) const
+    {
+        return MakeUsersView(Users).Subview(block * BlockRows, BlockCount(block));
+    }
+
+    void Update(const std::size_t row, const float balance, const bool active)
+    {
+        Users.Column<UserSchema::Balance>()[row] = balance;
+        Users.Column<UserSchema::Active>()[row] = active ? 1u : 0u;
+        ++BlockVersions[row / BlockRows];
+        ++DataVersion;
+    }
+};
+
+struct BlockAggregate
+{
+    double Sum;
+    uint64_t Count;
+};
+
+/* Scans one block for `Active && Balance >= minimumBalance`. When
+ * `WriteBitmap` is set, the qualifying rows are also recorded, one byte of
+ * bitmap per 8 rows straight from the compare mask. */
+template <bool WriteBitmap>
+FORCE_NOINLINE BlockAggregate ScanBlockAvx2(
+    const UsersView& blockView, const float minimumBalance,
+    uint64_t* RESTRICT_ALIAS bitmap)
+{
+    const std::size_t count = blockView.Count;
+    const float* RESTRICT_ALIAS balances = blockView.Balances;
+    const uint8_t* RESTRICT_ALIAS activeFlags = blockView.Active;
+    uint8_t* RESTRICT_ALIAS bitmapBytes = reinterpret_cast<uint8_t*>(bitmap);
+
+    if constexpr (WriteBitmap) {
+        if (count % 64 != 0) {
+            bitmap[count / 64] = 0;
+        }
+    }
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256i zero = _mm256_setzero_si256();
+
+    __m256 acc = _mm256_setzero_ps();
+    uint64_t qualifyingCount = 0;
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n8; i += vectorWidth) {
+        __m256 b = _mm256_loadu_ps(&balances[i]);
+        __m128i bytes =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&activeFlags[i]));
+        __m256i ints = _mm256_cvtepu8_epi32(bytes);
+        __m256 activeM = _mm256_castsi256_ps(_mm256_cmpgt_epi32(ints, zero));
+
+        __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
+        __m256 take = _mm256_and_ps(cmpMask, activeM);
+        acc = _mm256_add_ps(acc, _mm256_and_ps(b, take));
+
+        const uint32_t takeBits =
+            static_cast<uint32_t>(_mm256_movemask_ps(take));
+        qualifyingCount += static_cast<uint64_t>(std::popcount(takeBits));
+
+        if constexpr (WriteBitmap) {
+            bitmapBytes[i / vectorWidth] = static_cast<uint8_t>(takeBits);
+        }
+    }
+
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+
+    double accumulatedBalance = static_cast<double>(_mm_cvtss_f32(sum));
+
+    for (; i < count; ++i) {
+        if (activeFlags[i] && balances[i] >= minimumBalance) {
+            accumulatedBalance += static_cast<double>(balances[i]);
+            ++qualifyingCount;
+
+            if constexpr (WriteBitmap) {
+                bitmapBytes[i / vectorWidth] |=
+                    static_cast<uint8_t>(1u << (i % vectorWidth));
+            }
+        }
+    }
+
+    return BlockAggregate{accumulatedBalance, qualifyingCount};
+}
+
+struct NarrowedBlock
+{
+    BlockAggregate Aggregate;
+    uint64_t BytesRead;
+};
+
+/* Re-evaluates `Balance >= minimumBalance` only on the rows set in
+ * `candidates`, which already satisfy the predicate for a lower threshold, so
+ * the active flags are never read again. Sparse bitmap words walk their set
+ * bits; dense words compare all 64 balances with AVX2 and mask the result,
+ * since the cache lines are fetched either way. */
+FORCE_NOINLINE NarrowedBlock NarrowBlock(
+    const UsersView& blockView, const float minimumBalance,
+    const uint64_t* RESTRICT_ALIAS candidates, uint64_t* RESTRICT_ALIAS bitmap)
+{
+    const std::size_t count = blockView.Count;
+    const float* RESTRICT_ALIAS balances = blockView.Balances;
+
+    constexpr int32_t denseWordBits = 16;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256i laneSelect = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256 acc = _mm256_setzero_ps();
+
+    double accumulatedBalance = 0.0;
+    uint64_t qualifyingCount = 0;
+    uint64_t bytesRead = 0;
+
+    const std::size_t wordsCount = (count + 63) / 64;
+    for (std::size_t w = 0; w < wordsCount; ++w) {
+        uint64_t candidateBits = candidates[w];
+        uint64_t qualifyingBits = 0;
+        const float* RESTRICT_ALIAS wordBalances = balances + w * 64;
+
+        if (std::popcount(candidateBits) >= denseWordBits && (w + 1) * 64 <= count) {
+            for (std::size_t lane = 0; lane < 64; lane += 8) {
+                __m256 b = _mm256_loadu_ps(wordBalances + lane);
+                const uint64_t cmpBits = static_cast<uint64_t>(
+                    _mm256_movemask_ps(_mm256_cmp_ps(b, threshold, _CMP_GE_OQ)));
+                qualifyingBits |= cmpBits << lane;
+            }
+            qualifyingBits &= candidateBits;
+
+            for (std::size_t lane = 0; lane < 64; lane += 8) {
+                const __m256i laneBits = _mm256_set1_epi32(
+                    static_cast<int32_t>((qualifyingBits >> lane) & 0xFFu));
+                const __m256i laneMask = _mm256_cmpeq_epi32(
+                    _mm256_and_si256(laneBits, laneSelect), laneSelect);
+                acc = _mm256_add_ps(acc, _mm256_and_ps(
+                    _mm256_loadu_ps(wordBalances + lane),
+                    _mm256_castsi256_ps(laneMask)));
+            }
+
+            bytesRead += 64 * sizeof(float);
+        } else {
+            bytesRead += static_cast<uint64_t>(std::popcount(candidateBits))
+                * sizeof(float);
+
+            while (candidateBits != 0) {
+                const int32_t bit = std::countr_zero(candidateBits);
+                const float balanceValue = wordBalances[bit];
+                const bool bQualifies = balanceValue >= minimumBalance;
+
+                qualifyingBits |= static_cast<uint64_t>(bQualifies) << bit;
+                accumulatedBalance +=
+                    bQualifies ? static_cast<double>(balanceValue) : 0.0;
+
+                candidateBits &= candidateBits - 1;
+            }
+        }
+
+        qualifyingCount += static_cast<uint64_t>(std::popcount(qualifyingBits));
+        bitmap[w] = qualifyingBits;
+    }
+
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+
+    accumulatedBalance += static_cast<double>(_mm_cvtss_f32(sum));
+
+    return NarrowedBlock{
+        BlockAggregate{accumulatedBalance, qualifyingCount},
+        bytesRead + wordsCount * sizeof(uint64_t),
+    };
+}
+
+FORCE_NOINLINE BlockAggregate SumActiveBalancesFullScan(
+    const VersionedUsersTable& table, const float minimumBalance)
+{
+    BlockAggregate total{0.0, 0};
+
+    for (std::size_t block = 0; block < table.BlocksCount(); ++block) {
+        const BlockAggregate aggregate =
+            ScanBlockAvx2<false>(table.Block(block), minimumBalance, nullptr);
+
+        total.Sum += aggregate.Sum;
+        total.Count += aggregate.Count;
+    }
+
+    return total;
+}
+
+/*******************************************************************************
+* Predicate-result cache
+*******************************************************************************/
+
+/* Cached result of `Active && Balance >= MinimumBalance`: the row bitmap and
+ * per-block aggregates, each block stamped with the table block version it
+ * was computed from. `DataVersion` is the table version at which every block
+ * was last known to be current. */
+struct PredicateEntry
+{
+    float MinimumBalance;
+    uint64_t DataVersion;
+    uint64_t LastUsed;
+    BlockAggregate Total;
+    std::vector<uint64_t> BlockVersions;
+    std::vector<BlockAggregate> Blocks;
+    std::vector<uint64_t> Bitmap;
+};
+
+struct PredicateCacheStats
+{
+    uint64_t Lookups = 0;
+    uint64_t ExactHits = 0;
+    uint64_t RefreshedHits = 0;
+    uint64_t ContainmentHits = 0;
+    uint64_t Misses = 0;
+    uint64_t BlocksRescanned = 0;
+    uint64_t BytesScanned = 0;
+    uint64_t BytesFullScan = 0;
+};
+
+class PredicateCache
+{
+public:
+    explicit PredicateCache(const std::size_t capacity)
+        : Capacity(capacity)
+    {
+        Entries.reserve(capacity);
+    }
+
+    BlockAggregate SumActiveBalances(const VersionedUsersTable& table,
+                                     const float minimumBalance)
+    {
+        ++Stats.Lookups;
+        ++Tick;
+        Stats.BytesFullScan += table.Count() * RowBytes;
+
+        if (PredicateEntry* entry = FindExact(minimumBalance)) {
+            entry->LastUsed = Tick;
+
+            if (entry->DataVersion == table.DataVersion) {
+                ++Stats.ExactHits;
+            } else {
+                ++Stats.RefreshedHits;
+                Refresh(table, *entry);
+            }
+
+            return entry->Total;
+        }
+
+        const PredicateEntry* source = FindContaining(minimumBalance);
+        PredicateEntry& entry = Allocate(table, minimumBalance, source);
+
+        if (source != nullptr) {
+            ++Stats.ContainmentHits;
+        } else {
+            ++Stats.Misses;
+        }
+
+        for (std::size_t block = 0; block < table.BlocksCount(); ++block) {
+            const bool bSourceClean = source != nullptr
+                && source->BlockVersions[block] == table.BlockVersions[block];
+
+            if (bSourceClean) {
+                const NarrowedBlock narrowed = NarrowBlock(
+                    table.Block(block), minimumBalance,
+                    source->Bitmap.data() + block * BlockWords,
+                    entry.Bitmap.data() + block * BlockWords);
+                entry.Blocks[block] = narrowed.Aggregate;
+                entry.BlockVersions[block] = table.BlockVersions[block];
+
+                Stats.BytesScanned += narrowed.BytesRead;
+            } else {
+                ScanBlock(table, entry, block);
+            }
+        }
+
+        Recompute(table, entry);
+        return entry.Total;
+    }
+
+    const PredicateCacheStats& GetStats() const
+    {
+        return Stats;
+    }
+
+    std::size_t MemoryBytes() const
+    {
+        std::size_t bytes = 0;
+        for (const PredicateEntry& entry : Entries) {
+            bytes += entry.Bitmap.capacity() * sizeof(uint64_t)
+                + entry.Blocks.capacity() * sizeof(BlockAggregate)
+                + entry.BlockVersions.capacity() * sizeof(uint64_t);
+        }
+        return bytes;
+    }
+
+private:
+    PredicateEntry* FindExact(const float minimumBalance)
+    {
+        for (PredicateEntry& entry : Entries) {
+            if (entry.MinimumBalance == minimumBalance) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    /* The tightest cached superset: the highest cached threshold below the
+     * requested one, since its bitmap contains every row the query needs. */
+    const PredicateEntry* FindContaining(const float minimumBalance) const
+    {
+        const PredicateEntry* containing = nullptr;
+        for (const PredicateEntry& entry : Entries) {
+            if (entry.MinimumBalance < minimumBalance
+                    && (containing == nullptr
+                        || entry.MinimumBalance > containing->MinimumBalance)) {
+                containing = &entry;
+            }
+        }
+        return containing;
+    }
+
+    /* Reuses the least recently used entry once the cache is full, except
+     * `keep`, which the caller is still narrowing from. */
+    PredicateEntry& Allocate(const VersionedUsersTable& table,
+                             const float minimumBalance,
+                             const PredicateEntry* keep)
+    {
+        PredicateEntry* entry = nullptr;
+
+        if (Entries.size() < Capacity) {
+            entry = &Entries.emplace_back();
+        } else {
+            for (PredicateEntry& candidate : Entries) {
+                if (&candidate != keep
+                        && (entry == nullptr || candidate.LastUsed < entry->LastUsed)) {
+                    entry = &candidate;
+                }
+            }
+        }
+
+        entry->MinimumBalance = minimumBalance;
+        entry->LastUsed = Tick;
+        entry->BlockVersions.resize(table.BlocksCount());
+        entry->Blocks.resize(table.BlocksCount());
+        entry->Bitmap.resize(table.BlocksCount() * BlockWords);
+
+        return *entry;
+    }
+
+    void ScanBlock(const VersionedUsersTable& table, PredicateEntry& entry,
+                   const std::size_t block)
+    {
+        const UsersView blockView = table.Block(block);
+
+        entry.Blocks[block] = ScanBlockAvx2<true>(
+            blockView, entry.MinimumBalance,
+            entry.Bitmap.data() + block * BlockWords);
+        entry.BlockVersions[block] = table.BlockVersions[block];
+
+        ++Stats.BlocksRescanned;
+        Stats.BytesScanned += blockView.Count * RowBytes;
+    }
+
+    void Refresh(const VersionedUsersTable& table, PredicateEntry& entry)
+    {
+        for (std::size_t block = 0; block < table.BlocksCount(); ++block) {
+            if (entry.BlockVersions[block] != table.BlockVersions[block]) {
+                ScanBlock(table, entry, block);
+            }
+        }
+
+        Recompute(table, entry);
+    }
+
+    void Recompute(const VersionedUsersTable& table, PredicateEntry& entry)
+    {
+        entry.Total = BlockAggregate{0.0, 0};
+        for (const BlockAggregate& aggregate : entry.Blocks) {
+            entry.Total.Sum += aggregate.Sum;
+            entry.Total.Count += aggregate.Count;
+        }
+        entry.DataVersion = table.DataVersion;
+    }
+
+    std::size_t Capacity;
+    uint64_t Tick = 0;
+    std::vector<PredicateEntry> Entries;
+    PredicateCacheStats Stats;
+};
+
+/*******************************************************************************
+* Dashboard workload
+*******************************************************************************/
+
+/* Either a query at `MinimumBalance`, or (when `UpdatesCount` is non-zero) a
+ * burst of writes into one block, as recent activity tends to cluster. */
+struct WorkloadStep
+{
+    float MinimumBalance;
+    std::size_t UpdatesCount;
+    std::size_t FirstUpdate;
+};
+
+struct UserUpdate
+{
+    std::size_t Row;
+    float Balance;
+    bool Active;
+};
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t queriesCount = 1'000;
+    constexpr std::size_t queriesPerUpdateBurst = 25;
+    constexpr std::size_t updatesPerBurst = 256;
+    constexpr std::size_t cacheCapacity = 8;
+    constexpr double adHocQueryRate = 0.1;
+    constexpr float dashboardThresholds[] = {
+        250.0f, 300.0f, 400.0f, 500.0f, 750.0f,
+    };
+
+    std::println("");
+    std::println("[ DoD Predicate Cache Benchmark ]");
+    std::println("Elements Count        : {}", elementsCount);
+    std::println("Random Seed           : {}", randomSeed);
+    std::println("Queries               : {}", queriesCount);
+    std::println("Queries per Burst     : {}", queriesPerUpdateBurst);
+    std::println("Updates per Burst     : {}", updatesPerBurst);
+    std::println("Block Rows            : {}", BlockRows);
+    std::println("Cache Capacity        : {}", cacheCapacity);
+    std::println("Dashboard Thresholds  : {}", std::size(dashboardThresholds));
+    std::println("Ad-Hoc Query Rate     : {:.2f}", adHocQueryRate);
+
+    std::mt19937 randomEngine{randomSeed};
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+    std::bernoulli_distribution           activeDistribution{0.6};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    VersionedUsersTable table;
+    GenerateUsers(table.Users, elementsCount, randomEngine);
+
+    table.BlockVersions.assign(table.BlocksCount(), 0);
+
+    std::println("");
+    std::println("Generating workload...");
+
+    std::uniform_int_distribution<std::size_t> thresholdDistribution{
+        0, std::size(dashboardThresholds) - 1
+    };
+    std::uniform_int_distribution<std::size_t> blockDistribution{
+        0, table.BlocksCount() - 1
+    };
+    std::bernoulli_distribution adHocDistribution{adHocQueryRate};
+    std::uniform_int_distribution<int32_t> adHocThresholdDistribution{250, 999};
+
+    std::vector<WorkloadStep> workload;
+    std::vector<UserUpdate> updates;
+
+    for (std::size_t q = 0; q < queriesCount; ++q) {
+        if (q > 0 && q % queriesPerUpdateBurst == 0) {
+            const std::size_t block = blockDistribution(randomEngine);
+            std::uniform_int_distribution<std::size_t> rowDistribution{
+                block * BlockRows, block * BlockRows + table.BlockCount(block) - 1
+            };
+
+            workload.push_back(WorkloadStep{0.0f, updatesPerBurst, updates.size()});
+            for (std::size_t u = 0; u < updatesPerBurst; ++u) {
+                updates.push_back(UserUpdate{
+                    rowDistribution(randomEngine),
+                    balanceDistribution(randomEngine),
+                    activeDistribution(randomEngine),
+                });
+            }
+        }
+
+        const float minimumBalance = adHocDistribution(randomEngine)
+            ? static_cast<float>(adHocThresholdDistribution(randomEngine))
+            : dashboardThresholds[thresholdDistribution(randomEngine)];
+
+        workload.push_back(WorkloadStep{minimumBalance, 0, 0});
+    }
+
+    const auto applyUpdates = [&](VersionedUsersTable& target,
+                                  const WorkloadStep& step) {
+        for (std::size_t u = 0; u < step.UpdatesCount; ++u) {
+            const UserUpdate& update = updates[step.FirstUpdate + u];
+            target.Update(update.Row, update.Balance, update.Active);
+        }
+    };
+
+    std::println("");
+    std::println("Benchmarking full scans...");
+
+    VersionedUsersTable scanTable = table;
+    double scanChecksum = 0.0;
+    uint64_t scanQualifyingCount = 0;
+
+    const double scanTimeSeconds = MeasureExecutionTime(1, [&] {
+        for (const WorkloadStep& step : workload) {
+            if (step.UpdatesCount > 0) {
+                applyUpdates(scanTable, step);
+                continue;
+            }
+
+            const BlockAggregate result =
+                SumActiveBalancesFullScan(scanTable, step.MinimumBalance);
+            scanChecksum += result.Sum;
+            scanQualifyingCount += result.Count;
+        }
+        return 0.0f;
+    });
+
+    std::println("");
+    std::println("Benchmarking predicate cache...");
+
+    VersionedUsersTable cachedTable = table;
+    PredicateCache cache{cacheCapacity};
+    double cachedChecksum = 0.0;
+    uint64_t cachedQualifyingCount = 0;
+
+    const double cachedTimeSeconds = MeasureExecutionTime(1, [&] {
+        for (const WorkloadStep& step : workload) {
+            if (step.UpdatesCount > 0) {
+                applyUpdates(cachedTable, step);
+                continue;
+            }
+
+            const BlockAggregate result =
+                cache.SumActiveBalances(cachedTable, step.MinimumBalance);
+            cachedChecksum += result.Sum;
+            cachedQualifyingCount += result.Count;
+        }
+        return 0.0f;
+    });
+
+    const PredicateCacheStats& stats = cache.GetStats();
+    const uint64_t hits =
+        stats.ExactHits + stats.RefreshedHits + stats.ContainmentHits;
+
+    std::println("");
+    std::println("[ Full Scan Results ]");
+    std::println("Checksum                   : {:.8f}", scanChecksum);
+    std::println("Qualifying Rows            : {}", scanQualifyingCount);
+    std::println("Total Time                 : {:.2f} s", scanTimeSeconds);
+    std::println("Average Time per Query     : {:.2f} us",
+                 scanTimeSeconds * 1e6 / static_cast<double>(queriesCount));
+
+    std::println("");
+    std::println("[ Predicate Cache Results ]");
+    std::println("Checksum                   : {:.8f}", cachedChecksum);
+    std::println("Qualifying Rows            : {}", cachedQualifyingCount);
+    std::println("Total Time                 : {:.2f} s", cachedTimeSeconds);
+    std::println("Average Time per Query     : {:.2f} us",
+                 cachedTimeSeconds * 1e6 / static_cast<double>(queriesCount));
+    std::println("Speedup                    : {:.2f} x",
+                 scanTimeSeconds / cachedTimeSeconds);
+    std::println("Exact Hits                 : {}", stats.ExactHits);
+    std::println("Refreshed Hits             : {}", stats.RefreshedHits);
+    std::println("Containment Hits           : {}", stats.ContainmentHits);
+    std::println("Misses                     : {}", stats.Misses);
+    std::println("Hit Rate                   : {:.2f} %",
+                 100.0 * static_cast<double>(hits)
+                     / static_cast<double>(stats.Lookups));
+    std::println("Blocks Rescanned           : {}", stats.BlocksRescanned);
+    std::println("Bytes Scanned              : {:.2f} MB",
+                 static_cast<double>(stats.BytesScanned) / 1e6);
+    std::println("Bytes Full Scan Would Read : {:.2f} MB",
+                 static_cast<double>(stats.BytesFullScan) / 1e6);
+    std::println("Scan Bytes Saved           : {:.2f} %",
+                 100.0 * (1.0 - static_cast<double>(stats.BytesScanned)
+                     / static_cast<double>(stats.BytesFullScan)));
+    std::println("Cache Memory               : {:.2f} MB",
+                 static_cast<double>(cache.MemoryBytes()) / 1e6);
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
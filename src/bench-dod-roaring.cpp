@@ -0,0 +1,1189 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/* Roaring-style bitmap: rows are split into 64K-row chunks and each non-empty
+ * chunk is stored in whichever container is smallest for its contents:
+ *   Array  - sorted 16-bit offsets, for up to 4096 set rows;
+ *   Bitset - 1024 64-bit words;
+ *   Run    - sorted [Start, Last] intervals of consecutive set rows. */
+constexpr std::size_t ChunkBits = 16;
+constexpr std::size_t ChunkRows = std::size_t{1} << ChunkBits;
+constexpr std::size_t BitsetWords = ChunkRows / 64;
+constexpr std::size_t ArrayMaxCardinality = 4096;
+
+enum class EContainerType : uint8_t
+{
+    Array,
+    Bitset,
+    Run,
+};
+
+struct RunInterval
+{
+    uint16_t Start;
+    uint16_t Last;
+};
+
+struct RoaringContainer
+{
+    uint32_t Key;
+    EContainerType Type;
+    uint32_t Cardinality;
+    std::vector<uint16_t> Values;
+    AlignedVector<uint64_t> Words;
+    std::vector<RunInterval> Runs;
+
+    std::size_t GetSizeBytes() const
+    {
+        return sizeof(RoaringContainer)
+            + Values.capacity() * sizeof(uint16_t)
+            + Words.capacity() * sizeof(uint64_t)
+            + Runs.capacity() * sizeof(RunInterval);
+    }
+};
+
+#if defined(__AVX2__)
+/* Combines two bitset chunks 256 bits at a time and returns the population
+ * of the result. */
+template <class Op>
+uint32_t CombineWordsAvx2(const uint64_t* RESTRICT_ALIAS left,
+                          const uint64_t* RESTRICT_ALIAS right,
+                          uint64_t* RESTRICT_ALIAS result, Op&& op)
+{
+    for (std::size_t i = 0; i < BitsetWords; i += 4) {
+        const __m256i l = _mm256_load_si256(reinterpret_cast<const __m256i*>(left + i));
+        const __m256i r = _mm256_load_si256(reinterpret_cast<const __m256i*>(right + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(result + i), op(l, r));
+    }
+
+    uint32_t cardinality = 0;
+    for (std::size_t i = 0; i < BitsetWords; ++i) {
+        cardinality += static_cast<uint32_t>(std::popcount(result[i]));
+    }
+
+    return cardinality;
+}
+
+/* pshufb masks that pack the 16-bit lanes selected by an 8-bit mask to the
+ * front of a vector, in order; the unused bytes are zeroed. */
+constexpr std::array<std::array<uint8_t, 16>, 256> MakePackLanesTable()
+{
+    std::array<std::array<uint8_t, 16>, 256> table{};
+
+    for (std::size_t mask = 0; mask < table.size(); ++mask) {
+        std::size_t out = 0;
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            if ((mask >> lane) & 1u) {
+                table[mask][out++] = static_cast<uint8_t>(2 * lane);
+                table[mask][out++] = static_cast<uint8_t>(2 * lane + 1);
+            }
+        }
+        for (; out < 16; ++out) {
+            table[mask][out] = 0x80;
+        }
+    }
+
+    return table;
+}
+
+alignas(16) constexpr std::array<std::array<uint8_t, 16>, 256> PackLanesTable =
+    MakePackLanesTable();
+
+/* Stores the lanes of `values` selected by `mask` at `output` and returns
+ * how many there were. Always writes 16 bytes. */
+[[nodiscard]] std::size_t StorePackedLanes(const __m128i values, const uint32_t mask,
+                                           uint16_t* RESTRICT_ALIAS output)
+{
+    const __m128i shuffle = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(PackLanesTable[mask].data()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+                     _mm_shuffle_epi8(values, shuffle));
+
+    return static_cast<std::size_t>(std::popcount(mask));
+}
+
+/* One bit per 16-bit lane that is all ones. */
+[[nodiscard]] uint32_t LaneMask16(const __m128i lanes)
+{
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_packs_epi16(lanes, _mm_setzero_si128())));
+}
+
+/* Sorted-array intersection 8 offsets at a time: every lane of a block of
+ * `left` is compared with all 8 rotations of the current block of `right`,
+ * the matching lanes are packed to the output, and the block with the
+ * smaller maximum advances. The partial blocks at the ends fall back to
+ * std::set_intersection. `output` needs 8 slack values past the result. */
+std::size_t IntersectArraysAvx2(const std::span<const uint16_t> left,
+                                const std::span<const uint16_t> right,
+                                uint16_t* RESTRICT_ALIAS output)
+{
+    constexpr std::size_t vectorWidth = 8;
+
+    std::size_t l = 0;
+    std::size_t r = 0;
+    std::size_t count = 0;
+
+    if (left.size() >= vectorWidth && right.size() >= vectorWidth) {
+        const std::size_t leftEnd = left.size() / vectorWidth * vectorWidth;
+        const std::size_t rightEnd = right.size() / vectorWidth * vectorWidth;
+
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&left[l]));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&right[r]));
+
+        for (;;) {
+            __m128i matches = _mm_cmpeq_epi16(a, b);
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi16(a, _mm_alignr_epi8(b, b, 2)));
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi16(a, _mm_alignr_epi8(b, b, 4)));
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi16(a, _mm_alignr_epi8(b, b, 6)));
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi16(a, _mm_alignr_epi8(b, b, 8)));
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi16(a, _mm_alignr_epi8(b, b, 10)));
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi16(a, _mm_alignr_epi8(b, b, 12)));
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi16(a, _mm_alignr_epi8(b, b, 14)));
+
+            count += StorePackedLanes(a, LaneMask16(matches), output + count);
+
+            const uint16_t leftLast = left[l + vectorWidth - 1];
+            const uint16_t rightLast = right[r + vectorWidth - 1];
+
+            if (leftLast <= rightLast) {
+                l += vectorWidth;
+                if (l == leftEnd) {
+                    break;
+                }
+                a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&left[l]));
+            }
+            if (rightLast <= leftLast) {
+                r += vectorWidth;
+                if (r == rightEnd) {
+                    break;
+                }
+                b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&right[r]));
+            }
+        }
+    }
+
+    /* Offsets of the block left behind that matched earlier blocks of the
+     * other side are already out, and are smaller than anything the other
+     * side has left, so the tail cannot emit them again. */
+    const uint16_t* end = std::set_intersection(
+        left.begin() + static_cast<std::ptrdiff_t>(l), left.end(),
+        right.begin() + static_cast<std::ptrdiff_t>(r), right.end(),
+        output + count);
+
+    return static_cast<std::size_t>(end - output);
+}
+
+/* Merges two sorted vectors of 8 offsets into the 8 smallest and the 8
+ * largest, each sorted, by rotating the low half through the high one. */
+void MergeLanes(const __m128i left, const __m128i right, __m128i& low,
+                __m128i& high)
+{
+    __m128i rotated = _mm_min_epu16(left, right);
+    high = _mm_max_epu16(left, right);
+
+    for (std::size_t step = 0; step < 7; ++step) {
+        rotated = _mm_alignr_epi8(rotated, rotated, 2);
+        const __m128i lower = _mm_min_epu16(rotated, high);
+        high = _mm_max_epu16(rotated, high);
+        rotated = lower;
+    }
+
+    low = _mm_alignr_epi8(rotated, rotated, 2);
+}
+
+/* Stores the lanes of sorted `values` that differ from their predecessor,
+ * the first one being compared with the last lane of `previous`. */
+[[nodiscard]] std::size_t StoreUniqueLanes(const __m128i previous,
+                                           const __m128i values,
+                                           uint16_t* RESTRICT_ALIAS output)
+{
+    const __m128i shifted = _mm_alignr_epi8(values, previous, 14);
+    const uint32_t duplicates = LaneMask16(_mm_cmpeq_epi16(shifted, values));
+
+    return StorePackedLanes(values, ~duplicates & 0xFFu, output);
+}
+
+/* Sorted-array union 8 offsets at a time: the block with the smaller head
+ * is merged with the 8 largest offsets so far, and the 8 smallest are
+ * stored without duplicates. What is left of the merge and the partial
+ * blocks at the ends fall back to std::set_union. `output` needs 8 slack
+ * values past the result. */
+std::size_t UniteArraysAvx2(const std::span<const uint16_t> left,
+                            const std::span<const uint16_t> right,
+                            uint16_t* RESTRICT_ALIAS output)
+{
+    constexpr std::size_t vectorWidth = 8;
+
+    if (left.size() < vectorWidth || right.size() < vectorWidth) {
+        return static_cast<std::size_t>(
+            std::set_union(left.begin(), left.end(), right.begin(), right.end(),
+                           output) - output);
+    }
+
+    const std::size_t leftEnd = left.size() / vectorWidth * vectorWidth;
+    const std::size_t rightEnd = right.size() / vectorWidth * vectorWidth;
+
+    __m128i low;
+    __m128i high;
+    MergeLanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&left[0])),
+               _mm_loadu_si128(reinterpret_cast<const __m128i*>(&right[0])),
+               low, high);
+
+    std::size_t l = vectorWidth;
+    std::size_t r = vectorWidth;
+    std::size_t count = StoreUniqueLanes(_mm_set1_epi16(-1), low, output);
+    __m128i previous = low;
+
+    while (l < leftEnd && r < rightEnd) {
+        __m128i next;
+        if (left[l] <= right[r]) {
+            next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&left[l]));
+            l += vectorWidth;
+        } else {
+            next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&right[r]));
+            r += vectorWidth;
+        }
+
+        MergeLanes(next, high, low, high);
+        count += StoreUniqueLanes(previous, low, output + count);
+        previous = low;
+    }
+
+    /* The 8 largest merged offsets and the rest of the side that ran out of
+     * full blocks are at most 15 values; sorted, they are united with what
+     * the other side has left. */
+    std::array<uint16_t, 2 * vectorWidth> leftover;
+    std::size_t leftoverCount =
+        StoreUniqueLanes(previous, high, leftover.data());
+
+    const bool bLeftDone = l == leftEnd;
+    const std::span<const uint16_t> doneTail =
+        bLeftDone ? left.subspan(l) : right.subspan(r);
+    const std::span<const uint16_t> otherTail =
+        bLeftDone ? right.subspan(r) : left.subspan(l);
+
+    std::copy(doneTail.begin(), doneTail.end(), leftover.begin() + leftoverCount);
+    leftoverCount += doneTail.size();
+    std::sort(leftover.begin(), leftover.begin() + leftoverCount);
+    leftoverCount = static_cast<std::size_t>(
+        std::unique(leftover.begin(), leftover.begin() + leftoverCount)
+        - leftover.begin());
+
+    const uint16_t* end = std::set_union(
+        leftover.begin(), leftover.begin() + leftoverCount,
+        otherTail.begin(), otherTail.end(), output + count);
+
+    return static_cast<std::size_t>(end - output);
+}
+#endif  /* defined(__AVX2__) */
+
+class RoaringBitmap
+{
+public:
+    static RoaringBitmap FromFlags(const std::span<const uint8_t> flags)
+    {
+        RoaringBitmap bitmap;
+        AlignedVector<uint64_t> words(BitsetWords);
+
+        for (std::size_t begin = 0; begin < flags.size(); begin += ChunkRows) {
+            const std::size_t end = std::min(flags.size(), begin + ChunkRows);
+
+            std::fill(words.begin(), words.end(), uint64_t{0});
+            for (std::size_t i = begin; i < end; ++i) {
+                words[(i - begin) / 64] |=
+                    uint64_t{flags[i] != 0 ? 1u : 0u} << ((i - begin) % 64);
+            }
+
+            RoaringContainer container = FromWords(
+                static_cast<uint32_t>(begin >> ChunkBits), words.data());
+            if (container.Cardinality != 0) {
+                bitmap.Containers.push_back(std::move(container));
+            }
+        }
+
+        return bitmap;
+    }
+
+    static RoaringBitmap And(const RoaringBitmap& left, const RoaringBitmap& right)
+    {
+        RoaringBitmap result;
+        AlignedVector<uint64_t> leftWords(BitsetWords);
+        AlignedVector<uint64_t> rightWords(BitsetWords);
+        AlignedVector<uint64_t> resultWords(BitsetWords);
+
+        std::size_t l = 0;
+        std::size_t r = 0;
+        while (l < left.Containers.size() && r < right.Containers.size()) {
+            const RoaringContainer& a = left.Containers[l];
+            const RoaringContainer& b = right.Containers[r];
+
+            if (a.Key != b.Key) {
+                (a.Key < b.Key ? l : r) += 1;
+                continue;
+            }
+
+            RoaringContainer container;
+            if (a.Type == EContainerType::Array && b.Type == EContainerType::Array) {
+                container = IntersectArrays(a, b);
+            } else if (a.Type == EContainerType::Array || b.Type == EContainerType::Array) {
+                const RoaringContainer& array = a.Type == EContainerType::Array ? a : b;
+                const RoaringContainer& other = a.Type == EContainerType::Array ? b : a;
+                container = FilterArray(array, ToWords(other, rightWords.data()));
+            } else {
+                const uint64_t* aWords = ToWords(a, leftWords.data());
+                const uint64_t* bWords = ToWords(b, rightWords.data());
+                CombineWords(aWords, bWords, resultWords.data(), false);
+                container = FromWords(a.Key, resultWords.data());
+            }
+
+            if (container.Cardinality != 0) {
+                result.Containers.push_back(std::move(container));
+            }
+
+            ++l;
+            ++r;
+        }
+
+        return result;
+    }
+
+    static RoaringBitmap Or(const RoaringBitmap& left, const RoaringBitmap& right)
+    {
+        RoaringBitmap result;
+        AlignedVector<uint64_t> leftWords(BitsetWords);
+        AlignedVector<uint64_t> rightWords(BitsetWords);
+        AlignedVector<uint64_t> resultWords(BitsetWords);
+
+        std::size_t l = 0;
+        std::size_t r = 0;
+        while (l < left.Containers.size() || r < right.Containers.size()) {
+            if (r == right.Containers.size()
+                || (l < left.Containers.size()
+                    && left.Containers[l].Key < right.Containers[r].Key)) {
+                result.Containers.push_back(left.Containers[l++]);
+                continue;
+            }
+
+            if (l == left.Containers.size()
+                || right.Containers[r].Key < left.Containers[l].Key) {
+                result.Containers.push_back(right.Containers[r++]);
+                continue;
+            }
+
+            const RoaringContainer& a = left.Containers[l++];
+            const RoaringContainer& b = right.Containers[r++];
+
+            if (a.Type == EContainerType::Array && b.Type == EContainerType::Array
+                && a.Cardinality + b.Cardinality <= ArrayMaxCardinality) {
+                result.Containers.push_back(UniteArrays(a, b));
+                continue;
+            }
+
+            const uint64_t* aWords = ToWords(a, leftWords.data());
+            const uint64_t* bWords = ToWords(b, rightWords.data());
+            CombineWords(aWords, bWords, resultWords.data(), true);
+            result.Containers.push_back(FromWords(a.Key, resultWords.data()));
+        }
+
+        return result;
+    }
+
+    std::span<const RoaringContainer> GetContainers() const
+    {
+        return Containers;
+    }
+
+    std::size_t GetCardinality() const
+    {
+        std::size_t cardinality = 0;
+        for (const RoaringContainer& container : Containers) {
+            cardinality += container.Cardinality;
+        }
+
+        return cardinality;
+    }
+
+    std::size_t GetSizeBytes() const
+    {
+        std::size_t sizeBytes = sizeof(RoaringBitmap);
+        for (const RoaringContainer& container : Containers) {
+            sizeBytes += container.GetSizeBytes();
+        }
+
+        return sizeBytes;
+    }
+
+    std::size_t CountContainers(const EContainerType type) const
+    {
+        return static_cast<std::size_t>(std::count_if(
+            Containers.begin(), Containers.end(),
+            [&](const RoaringContainer& container) {
+                return container.Type == type;
+            }));
+    }
+
+    /* Calls `fn(row)` for every set row, in ascending order. */
+    template <class F>
+    void ForEach(F&& fn) const
+    {
+        for (const RoaringContainer& container : Containers) {
+            const std::size_t base = std::size_t{container.Key} << ChunkBits;
+
+            switch (container.Type) {
+            case EContainerType::Array:
+                for (const uint16_t value : container.Values) {
+                    fn(base + value);
+                }
+                break;
+            case EContainerType::Bitset:
+                for (std::size_t w = 0; w < BitsetWords; ++w) {
+                    for (uint64_t bits = container.Words[w]; bits != 0; bits &= bits - 1) {
+                        fn(base + w * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+                    }
+                }
+                break;
+            case EContainerType::Run:
+                for (const RunInterval& run : container.Runs) {
+                    for (std::size_t row = run.Start; row <= run.Last; ++row) {
+                        fn(base + row);
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+private:
+    /* Picks the smallest container for a chunk, following Roaring's rules:
+     * arrays cost 2 bytes per row, bitsets a flat 8 KiB, runs 4 bytes per
+     * run. */
+    static RoaringContainer FromWords(const uint32_t key,
+                                      const uint64_t* RESTRICT_ALIAS words)
+    {
+        uint32_t cardinality = 0;
+        uint32_t runsCount = 0;
+        uint64_t carry = 0;
+
+        for (std::size_t w = 0; w < BitsetWords; ++w) {
+            cardinality += static_cast<uint32_t>(std::popcount(words[w]));
+            const uint64_t runStarts = words[w] & ~((words[w] << 1) | carry);
+            runsCount += static_cast<uint32_t>(std::popcount(runStarts));
+            carry = words[w] >> 63;
+        }
+
+        RoaringContainer container{key, EContainerType::Bitset, cardinality, {}, {}, {}};
+
+        const std::size_t arrayBytes = cardinality <= ArrayMaxCardinality
+            ? cardinality * sizeof(uint16_t) : SIZE_MAX;
+        const std::size_t bitsetBytes = BitsetWords * sizeof(uint64_t);
+        const std::size_t runBytes = runsCount * sizeof(RunInterval);
+
+        if (runBytes < std::min(arrayBytes, bitsetBytes)) {
+            container.Type = EContainerType::Run;
+            container.Runs.reserve(runsCount);
+
+            std::size_t row = 0;
+            while (row < ChunkRows) {
+                const uint64_t word = words[row / 64] >> (row % 64);
+                if (word == 0) {
+                    row = (row / 64 + 1) * 64;
+                    continue;
+                }
+
+                const std::size_t start = row + static_cast<std::size_t>(std::countr_zero(word));
+
+                /* Counts trailing ones word by word; a run only continues
+                 * into the next word when it reached the top bit. */
+                std::size_t end = start;
+                for (;;) {
+                    const std::size_t bit = end % 64;
+                    const std::size_t ones = static_cast<std::size_t>(
+                        std::countr_one(words[end / 64] >> bit));
+                    end += ones;
+
+                    if (ones < 64 - bit || end == ChunkRows) {
+                        break;
+                    }
+                }
+
+                container.Runs.push_back(RunInterval{
+                    static_cast<uint16_t>(start), static_cast<uint16_t>(end - 1),
+                });
+                row = end;
+            }
+        } else if (arrayBytes < bitsetBytes) {
+            container.Type = EContainerType::Array;
+            container.Values.reserve(cardinality);
+
+            for (std::size_t w = 0; w < BitsetWords; ++w) {
+                for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                    container.Values.push_back(static_cast<uint16_t>(
+                        w * 64 + static_cast<std::size_t>(std::countr_zero(bits))));
+                }
+            }
+        } else {
+            container.Words.assign(words, words + BitsetWords);
+        }
+
+        return container;
+    }
+
+    /* Returns the container as bitset words, materializing arrays and runs
+     * into `scratch`. */
+    static const uint64_t* ToWords(const RoaringContainer& container,
+                                   uint64_t* RESTRICT_ALIAS scratch)
+    {
+        if (container.Type == EContainerType::Bitset) {
+            return container.Words.data();
+        }
+
+        std::fill_n(scratch, BitsetWords, uint64_t{0});
+
+        if (container.Type == EContainerType::Array) {
+            for (const uint16_t value : container.Values) {
+                scratch[value / 64] |= uint64_t{1} << (value % 64);
+            }
+        } else {
+            for (const RunInterval& run : container.Runs) {
+                const std::size_t firstWord = run.Start / 64;
+                const std::size_t lastWord = run.Last / 64;
+
+                for (std::size_t w = firstWord; w <= lastWord; ++w) {
+                    const std::size_t low = w == firstWord ? run.Start % 64 : 0;
+                    const std::size_t high = w == lastWord ? run.Last % 64 : 63;
+                    scratch[w] |= (~uint64_t{0} >> (63 - high)) & (~uint64_t{0} << low);
+                }
+            }
+        }
+
+        return scratch;
+    }
+
+    static void CombineWords(const uint64_t* RESTRICT_ALIAS left,
+                             const uint64_t* RESTRICT_ALIAS right,
+                             uint64_t* RESTRICT_ALIAS result, const bool bUnion)
+    {
+#if defined(__AVX2__)
+        if (bUnion) {
+            CombineWordsAvx2(left, right, result, [](const __m256i l, const __m256i r) {
+                return _mm256_or_si256(l, r);
+            });
+        } else {
+            CombineWordsAvx2(left, right, result, [](const __m256i l, const __m256i r) {
+                return _mm256_and_si256(l, r);
+            });
+        }
+#else   /* defined(__AVX2__) */
+        for (std::size_t i = 0; i < BitsetWords; ++i) {
+            result[i] = bUnion ? (left[i] | right[i]) : (left[i] & right[i]);
+        }
+#endif  /* defined(__AVX2__) */
+    }
+
+    static RoaringContainer IntersectArrays(const RoaringContainer& a,
+                                            const RoaringContainer& b)
+    {
+        RoaringContainer container{a.Key, EContainerType::Array, 0, {}, {}, {}};
+
+#if defined(__AVX2__)
+        /* The vector kernels store whole vectors, so the output gets 8
+         * values of slack before it is trimmed to the result. */
+        container.Values.resize(std::min(a.Values.size(), b.Values.size()) + 8);
+        container.Values.resize(
+            IntersectArraysAvx2(a.Values, b.Values, container.Values.data()));
+#else   /* defined(__AVX2__) */
+        container.Values.reserve(std::min(a.Values.size(), b.Values.size()));
+
+        std::set_intersection(a.Values.begin(), a.Values.end(),
+                              b.Values.begin(), b.Values.end(),
+                              std::back_inserter(container.Values));
+#endif  /* defined(__AVX2__) */
+
+        container.Cardinality = static_cast<uint32_t>(container.Values.size());
+
+        return container;
+    }
+
+    static RoaringContainer UniteArrays(const RoaringContainer& a,
+                                        const RoaringContainer& b)
+    {
+        RoaringContainer container{a.Key, EContainerType::Array, 0, {}, {}, {}};
+
+#if defined(__AVX2__)
+        container.Values.resize(a.Values.size() + b.Values.size() + 8);
+        container.Values.resize(
+            UniteArraysAvx2(a.Values, b.Values, container.Values.data()));
+#else   /* defined(__AVX2__) */
+        container.Values.reserve(a.Values.size() + b.Values.size());
+
+        std::set_union(a.Values.begin(), a.Values.end(),
+                       b.Values.begin(), b.Values.end(),
+                       std::back_inserter(container.Values));
+#endif  /* defined(__AVX2__) */
+
+        container.Cardinality = static_cast<uint32_t>(container.Values.size());
+
+        return container;
+    }
+
+    static RoaringContainer FilterArray(const RoaringContainer& array,
+                                        const uint64_t* RESTRICT_ALIAS words)
+    {
+        RoaringContainer container{array.Key, EContainerType::Array, 0, {}, {}, {}};
+        container.Values.reserve(array.Values.size());
+
+        for (const uint16_t value : array.Values) {
+            if ((words[value / 64] >> (value % 64)) & 1u) {
+                container.Values.push_back(value);
+            }
+        }
+        container.Cardinality = static_cast<uint32_t>(container.Values.size());
+
+        return container;
+    }
+
+    std::vector<RoaringContainer> Containers;
+};
+
+FORCE_NOINLINE float SumActiveBalancesRoaringScalar(
+    const RoaringBitmap& activeSet, const float* RESTRICT_ALIAS balances,
+    const float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    activeSet.ForEach([&](const std::size_t row) {
+        const float balanceValue = balances[row];
+        const float takeValue = balanceValue >= minimumBalance ? 1.0f : 0.0f;
+        accumulatedBalance += balanceValue * takeValue;
+    });
+
+    return accumulatedBalance;
+}
+
+#if defined(__AVX2__)
+[[nodiscard]] float HorizontalSum(const __m256 acc)
+{
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+
+    return _mm_cvtss_f32(sum);
+}
+
+/* Masks 8 balances with 8 bits of a bitmap: lane k is kept when bit k is set
+ * and the balance passes the threshold. */
+[[nodiscard]] __m256 MaskedBalances(const float* balances, const uint32_t bits,
+                                    const __m256 threshold)
+{
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+    const __m256 b = _mm256_loadu_ps(balances);
+    const __m256i activeM = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits)), laneBits),
+        laneBits);
+    const __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
+
+    return _mm256_and_ps(b, _mm256_and_ps(cmpMask, _mm256_castsi256_ps(activeM)));
+}
+
+FORCE_NOINLINE float SumActiveBalancesBitmapAvx2(
+    const float* RESTRICT_ALIAS balances,
+    const uint64_t* RESTRICT_ALIAS activeWords,
+    const std::size_t count, float minimumBalance)
+{
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+
+    __m256 acc = _mm256_setzero_ps();
+
+    const std::size_t n64 = (count / 64) * 64;
+
+    std::size_t i = 0;
+    for (; i < n64; i += 64) {
+        const uint64_t word = activeWords[i / 64];
+        for (std::size_t k = 0; k < 64; k += 8) {
+            acc = _mm256_add_ps(acc, MaskedBalances(
+                balances + i + k, static_cast<uint32_t>((word >> k) & 0xFF),
+                threshold));
+        }
+    }
+
+    float accumulatedBalance = HorizontalSum(acc);
+
+    for (; i < count; ++i) {
+        const bool bActive = (activeWords[i / 64] >> (i % 64)) & 1u;
+        if (bActive && balances[i] >= minimumBalance) {
+            accumulatedBalance += balances[i];
+        }
+    }
+
+    return accumulatedBalance;
+}
+
+/* Visits only the set rows: arrays gather their balances, bitsets skip empty
+ * words and walk sparse ones bit by bit, and runs are summed as dense ranges
+ * with no mask at all. */
+FORCE_NOINLINE float SumActiveBalancesRoaringAvx2(
+    const RoaringBitmap& activeSet, const float* RESTRICT_ALIAS balances,
+    float minimumBalance)
+{
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+
+    __m256 acc = _mm256_setzero_ps();
+    float accumulatedBalance = 0.0f;
+
+    const auto addScalar = [&](const float balanceValue) {
+        if (balanceValue >= minimumBalance) {
+            accumulatedBalance += balanceValue;
+        }
+    };
+
+    for (const RoaringContainer& container : activeSet.GetContainers()) {
+        const float* chunk = balances + (std::size_t{container.Key} << ChunkBits);
+
+        switch (container.Type) {
+        case EContainerType::Array: {
+            const uint16_t* values = container.Values.data();
+            const std::size_t count = container.Values.size();
+            const std::size_t n8 = (count / 8) * 8;
+
+            std::size_t i = 0;
+            for (; i < n8; i += 8) {
+                const __m256i offsets = _mm256_cvtepu16_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+                const __m256 b = _mm256_i32gather_ps(chunk, offsets, 4);
+                const __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
+                acc = _mm256_add_ps(acc, _mm256_and_ps(b, cmpMask));
+            }
+
+            for (; i < count; ++i) {
+                addScalar(chunk[values[i]]);
+            }
+            break;
+        }
+        case EContainerType::Bitset:
+            for (std::size_t w = 0; w < BitsetWords; ++w) {
+                const uint64_t word = container.Words[w];
+                if (word == 0) {
+                    continue;
+                }
+
+                const float* wordBalances = chunk + w * 64;
+
+                if (std::popcount(word) >= 16) {
+                    for (std::size_t k = 0; k < 64; k += 8) {
+                        const uint32_t bits = static_cast<uint32_t>((word >> k) & 0xFF);
+                        if (bits != 0) {
+                            acc = _mm256_add_ps(acc, MaskedBalances(
+                                wordBalances + k, bits, threshold));
+                        }
+                    }
+                } else {
+                    for (uint64_t bits = word; bits != 0; bits &= bits - 1) {
+                        addScalar(wordBalances[std::countr_zero(bits)]);
+                    }
+                }
+            }
+            break;
+        case EContainerType::Run:
+            for (const RunInterval& run : container.Runs) {
+                const float* runBalances = chunk + run.Start;
+                const std::size_t count =
+                    static_cast<std::size_t>(run.Last - run.Start) + 1;
+                const std::size_t n8 = (count / 8) * 8;
+
+                std::size_t i = 0;
+                for (; i < n8; i += 8) {
+                    const __m256 b = _mm256_loadu_ps(runBalances + i);
+                    const __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
+                    acc = _mm256_add_ps(acc, _mm256_and_ps(b, cmpMask));
+                }
+
+                for (; i < count; ++i) {
+                    addScalar(runBalances[i]);
+                }
+            }
+            break;
+        }
+    }
+
+    return accumulatedBalance + HorizontalSum(acc);
+}
+#endif  /* defined(__AVX2__) */
+
+FORCE_NOINLINE std::size_t CombineBitmaps(
+    const uint64_t* RESTRICT_ALIAS left, const uint64_t* RESTRICT_ALIAS right,
+    uint64_t* RESTRICT_ALIAS result, const std::size_t wordsCount,
+    const bool bUnion)
+{
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 4 <= wordsCount; i += 4) {
+        const __m256i l = _mm256_load_si256(reinterpret_cast<const __m256i*>(left + i));
+        const __m256i r = _mm256_load_si256(reinterpret_cast<const __m256i*>(right + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(result + i),
+                           bUnion ? _mm256_or_si256(l, r) : _mm256_and_si256(l, r));
+    }
+#endif  /* defined(__AVX2__) */
+
+    for (; i < wordsCount; ++i) {
+        result[i] = bUnion ? (left[i] | right[i]) : (left[i] & right[i]);
+    }
+
+    std::size_t cardinality = 0;
+    for (std::size_t w = 0; w < wordsCount; ++w) {
+        cardinality += static_cast<std::size_t>(std::popcount(result[w]));
+    }
+
+    return cardinality;
+}
+
+[[nodiscard]] AlignedVector<uint64_t> PackBitmap(const std::span<const uint8_t> flags)
+{
+    AlignedVector<uint64_t> words((flags.size() + 63) / 64, 0);
+
+    for (std::size_t i = 0; i < flags.size(); ++i) {
+        words[i / 64] |= uint64_t{flags[i] != 0 ? 1u : 0u} << (i % 64);
+    }
+
+    return words;
+}
+
+struct Scenario
+{
+    const char* Name;
+    double ActiveRate;
+    double MeanRunLength;
+};
+
+/* Random scenarios draw every flag independently; run scenarios alternate
+ * active and inactive runs with geometric lengths in the same ratio. */
+void GenerateFlags(const Scenario& scenario, std::mt19937& randomEngine,
+                   const std::span<uint8_t> flags)
+{
+    if (scenario.MeanRunLength <= 1.0) {
+        std::bernoulli_distribution activeDistribution{scenario.ActiveRate};
+        for (uint8_t& flag : flags) {
+            flag = activeDistribution(randomEngine) ? 1u : 0u;
+        }
+        return;
+    }
+
+    std::geometric_distribution<std::size_t> activeRunDistribution{
+        1.0 / scenario.MeanRunLength
+    };
+    std::geometric_distribution<std::size_t> inactiveRunDistribution{
+        1.0 / (scenario.MeanRunLength * (1.0 - scenario.ActiveRate)
+               / scenario.ActiveRate)
+    };
+
+    bool bActive = false;
+    std::size_t i = 0;
+    while (i < flags.size()) {
+        const std::size_t length = 1 + (bActive
+            ? activeRunDistribution(randomEngine)
+            : inactiveRunDistribution(randomEngine));
+        const std::size_t end = std::min(flags.size(), i + length);
+        std::fill(flags.begin() + static_cast<std::ptrdiff_t>(i),
+                  flags.begin() + static_cast<std::ptrdiff_t>(end),
+                  bActive ? uint8_t{1} : uint8_t{0});
+        i = end;
+        bActive = !bActive;
+    }
+}
+
+struct ScenarioResults
+{
+    const char* Name;
+    double ActiveRate;
+    double RoaringBytesPerRow;
+    std::size_t Arrays;
+    std::size_t Bitsets;
+    std::size_t Runs;
+    bool bPositionsMatch;
+    float FlagsChecksum;
+    float RoaringScalarChecksum;
+    float RoaringChecksum;
+    bool bChecksumsMatch;
+    double FlagsSeconds;
+    double BitmapSeconds;
+    double RoaringScalarSeconds;
+    double RoaringSeconds;
+    double BitmapAndSeconds;
+    double RoaringAndSeconds;
+    double BitmapOrSeconds;
+    double RoaringOrSeconds;
+    bool bSetOpsMatch;
+};
+
+template <class F>
+double MeasureAverageTime(const std::size_t warmupIterations,
+                          const std::size_t iterations, float& checksum, F&& f)
+{
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        checksum = f();
+    }
+
+    return MeasureExecutionTime(iterations, f) / static_cast<double>(iterations);
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+    constexpr double otherSetRate = 0.1;
+
+    constexpr Scenario scenarios[] = {
+        {"0.1% Random", 0.001, 1.0},
+        {"1% Random", 0.01, 1.0},
+        {"10% Random", 0.1, 1.0},
+        {"60% Random", 0.6, 1.0},
+        {"99% Random", 0.99, 1.0},
+        {"1% Runs", 0.01, 64.0},
+        {"60% Runs", 0.6, 1024.0},
+    };
+
+    std::println("");
+    std::println("[ DoD Roaring Bitmap Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Other Set Rate    : {:.2f} %", otherSetRate * 100.0);
+
+    std::mt19937 randomEngine{randomSeed};
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    /* The active flags are drawn per scenario below, so the users table is
+     * filled here rather than with GenerateUsers. */
+    UsersTable users;
+    users.Resize(elementsCount);
+
+    const std::span<int32_t> ids = users.Column<UserSchema::Id>();
+    const std::span<float> balances = users.Column<UserSchema::Balance>();
+    const std::span<uint8_t> activeFlags = users.Column<UserSchema::Active>();
+
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        ids[i] = static_cast<int32_t>(i);
+        balances[i] = balanceDistribution(randomEngine);
+    }
+
+    const UsersView usersView = MakeUsersView(users);
+
+    /* The second operand of the set operations, e.g. a "premium" segment. */
+    AlignedVector<uint8_t> otherFlags(elementsCount);
+    GenerateFlags(Scenario{"Other", otherSetRate, 1.0}, randomEngine, otherFlags);
+
+    const RoaringBitmap otherSet = RoaringBitmap::FromFlags(otherFlags);
+    const AlignedVector<uint64_t> otherWords = PackBitmap(otherFlags);
+
+    AlignedVector<uint64_t> resultWords(otherWords.size());
+
+    std::vector<ScenarioResults> results;
+
+    for (const Scenario& scenario : scenarios) {
+        std::println("Benchmarking {}...", scenario.Name);
+
+        GenerateFlags(scenario, randomEngine, activeFlags);
+
+        const RoaringBitmap activeSet = RoaringBitmap::FromFlags(activeFlags);
+        const AlignedVector<uint64_t> activeWords = PackBitmap(activeFlags);
+
+        std::size_t flagsCardinality = 0;
+        bool bPositionsMatch = true;
+        for (const uint8_t flag : activeFlags) {
+            flagsCardinality += flag;
+        }
+        activeSet.ForEach([&](const std::size_t row) {
+            bPositionsMatch = bPositionsMatch && activeFlags[row] != 0;
+        });
+        bPositionsMatch =
+            bPositionsMatch && activeSet.GetCardinality() == flagsCardinality;
+
+        ScenarioResults scenarioResults{};
+        scenarioResults.Name = scenario.Name;
+        scenarioResults.ActiveRate = static_cast<double>(flagsCardinality)
+            / static_cast<double>(elementsCount);
+        scenarioResults.RoaringBytesPerRow =
+            static_cast<double>(activeSet.GetSizeBytes())
+            / static_cast<double>(elementsCount);
+        scenarioResults.Arrays = activeSet.CountContainers(EContainerType::Array);
+        scenarioResults.Bitsets = activeSet.CountContainers(EContainerType::Bitset);
+        scenarioResults.Runs = activeSet.CountContainers(EContainerType::Run);
+        scenarioResults.bPositionsMatch = bPositionsMatch;
+
+        float checksum = 0.0f;
+
+        scenarioResults.RoaringScalarSeconds = MeasureAverageTime(
+            warmupIterations, iterations, checksum, [&] {
+                return SumActiveBalancesRoaringScalar(
+                    activeSet, balances.data(), minimumBalance);
+            });
+        scenarioResults.RoaringScalarChecksum = checksum;
+
+        /* The scalar flag scan keeps one float accumulator in row order, and
+         * the scalar Roaring walk visits the same rows in the same order, so
+         * the two must match bit for bit. */
+        scenarioResults.bChecksumsMatch =
+            scenarioResults.RoaringScalarChecksum
+                == SumActiveBalancesScalar(usersView, minimumBalance);
+
+#if defined(__AVX2__)
+        scenarioResults.FlagsSeconds = MeasureAverageTime(
+            warmupIterations, iterations, checksum, [&] {
+                return SumActiveBalancesAvx2(usersView, minimumBalance);
+            });
+        scenarioResults.FlagsChecksum = checksum;
+
+        scenarioResults.BitmapSeconds = MeasureAverageTime(
+            warmupIterations, iterations, checksum, [&] {
+                return SumActiveBalancesBitmapAvx2(balances.data(), activeWords.data(),
+                                                   elementsCount, minimumBalance);
+            });
+
+        scenarioResults.RoaringSeconds = MeasureAverageTime(
+            warmupIterations, iterations, checksum, [&] {
+                return SumActiveBalancesRoaringAvx2(
+                    activeSet, balances.data(), minimumBalance);
+            });
+        scenarioResults.RoaringChecksum = checksum;
+
+        /* The vector kernels sum in lanes, so they only have to land within
+         * 0.1% of the double reference. */
+        const double referenceChecksum =
+            SumActiveBalancesScalarDouble(usersView, minimumBalance);
+        const auto matchesReference = [&](const float kernelChecksum) {
+            return std::abs(static_cast<double>(kernelChecksum) - referenceChecksum)
+                <= 1e-3 * std::max(1.0, referenceChecksum);
+        };
+
+        scenarioResults.bChecksumsMatch = scenarioResults.bChecksumsMatch
+            && matchesReference(scenarioResults.FlagsChecksum)
+            && matchesReference(scenarioResults.RoaringChecksum);
+#endif  /* defined(__AVX2__) */
+
+        std::size_t bitmapAndCardinality = 0;
+        std::size_t bitmapOrCardinality = 0;
+        std::size_t roaringAndCardinality = 0;
+        std::size_t roaringOrCardinality = 0;
+
+        scenarioResults.BitmapAndSeconds = MeasureAverageTime(
+            warmupIterations, iterations, checksum, [&] {
+                bitmapAndCardinality = CombineBitmaps(
+                    activeWords.data(), otherWords.data(), resultWords.data(),
+                    resultWords.size(), false);
+                return static_cast<float>(bitmapAndCardinality);
+            });
+        scenarioResults.BitmapOrSeconds = MeasureAverageTime(
+            warmupIterations, iterations, checksum, [&] {
+                bitmapOrCardinality = CombineBitmaps(
+                    activeWords.data(), otherWords.data(), resultWords.data(),
+                    resultWords.size(), true);
+                return static_cast<float>(bitmapOrCardinality);
+            });
+        scenarioResults.RoaringAndSeconds = MeasureAverageTime(
+            warmupIterations, iterations, checksum, [&] {
+                roaringAndCardinality =
+                    RoaringBitmap::And(activeSet, otherSet).GetCardinality();
+                return static_cast<float>(roaringAndCardinality);
+            });
+        scenarioResults.RoaringOrSeconds = MeasureAverageTime(
+            warmupIterations, iterations, checksum, [&] {
+                roaringOrCardinality =
+                    RoaringBitmap::Or(activeSet, otherSet).GetCardinality();
+                return static_cast<float>(roaringOrCardinality);
+            });
+
+        scenarioResults.bSetOpsMatch = bitmapAndCardinality == roaringAndCardinality
+            && bitmapOrCardinality == roaringOrCardinality;
+
+        results.push_back(scenarioResults);
+    }
+
+    const auto nanosecondsPerElement = [&](const double averageTimeSeconds) {
+        return (averageTimeSeconds * 1e9) / static_cast<double>(elementsCount);
+    };
+
+    std::println("");
+    std::println("[ Footprint Results (Bytes per Row) ]");
+    std::println("Byte Flags        : {:.4f}", 1.0);
+    std::println("Plain Bitmap      : {:.4f}", 0.125);
+    std::println("");
+    std::println("{:<12} | {:>8} | {:>13} | {:>6} | {:>7} | {:>4} | {:>9}",
+                 "Scenario", "Active %", "Roaring Bytes", "Arrays", "Bitsets",
+                 "Runs", "Positions");
+
+    for (const ScenarioResults& scenarioResults : results) {
+        std::println("{:<12} | {:>8.2f} | {:>13.4f} | {:>6} | {:>7} | {:>4} | {:>9}",
+                     scenarioResults.Name, scenarioResults.ActiveRate * 100.0,
+                     scenarioResults.RoaringBytesPerRow, scenarioResults.Arrays,
+                     scenarioResults.Bitsets, scenarioResults.Runs,
+                     scenarioResults.bPositionsMatch ? "match" : "MISMATCH");
+    }
+
+    std::println("");
+    std::println("[ Scan Results (Nanoseconds per Element) ]");
+    std::println("{:<12} | {:>10} | {:>10} | {:>14} | {:>12} | {:>16} | {:>16} | {:>16} | {:>9}",
+                 "Scenario", "Flags AVX2", "Bitmap AVX2", "Roaring Scalar",
+                 "Roaring AVX2", "Flags Checksum", "Scalar Checksum",
+                 "AVX2 Checksum", "Checksums");
+
+    for (const ScenarioResults& scenarioResults : results) {
+        std::println("{:<12} | {:>10.3f} | {:>11.3f} | {:>14.3f} | {:>12.3f} | {:>16.2f} | {:>16.2f} | {:>16.2f} | {:>9}",
+                     scenarioResults.Name,
+                     nanosecondsPerElement(scenarioResults.FlagsSeconds),
+                     nanosecondsPerElement(scenarioResults.BitmapSeconds),
+                     nanosecondsPerElement(scenarioResults.RoaringScalarSeconds),
+                     nanosecondsPerElement(scenarioResults.RoaringSeconds),
+                     scenarioResults.FlagsChecksum,
+                     scenarioResults.RoaringScalarChecksum,
+                     scenarioResults.RoaringChecksum,
+                     scenarioResults.bChecksumsMatch ? "match" : "MISMATCH");
+    }
+
+    std::println("");
+    std::println("[ Set Operation Results (Milliseconds) ]");
+    std::println("{:<12} | {:>10} | {:>11} | {:>10} | {:>11} | {:>11}",
+                 "Scenario", "Bitmap AND", "Roaring AND", "Bitmap OR",
+                 "Roaring OR", "Cardinality");
+
+    for (const ScenarioResults& scenarioResults : results) {
+        std::println("{:<12} | {:>10.3f} | {:>11.3f} | {:>10.3f} | {:>11.3f} | {:>11}",
+                     scenarioResults.Name,
+                     scenarioResults.BitmapAndSeconds * 1e3,
+                     scenarioResults.RoaringAndSeconds * 1e3,
+                     scenarioResults.BitmapOrSeconds * 1e3,
+                     scenarioResults.RoaringOrSeconds * 1e3,
+                     scenarioResults.bSetOpsMatch ? "match" : "MISMATCH");
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
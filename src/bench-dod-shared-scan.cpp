@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <print>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/* Independent scan: one query walks the whole column on its own, block by
+ * block, so every concurrent query pays the full memory traffic. */
+double SumActiveBalances(const SumActiveBalancesFn sumActiveBalances,
+                         const UsersView& usersView, const std::size_t blockRows,
+                         const float minimumBalance)
+{
+    double accumulatedBalance = 0.0;
+
+    for (std::size_t first = 0; first < usersView.Count; first += blockRows) {
+        const std::size_t count = std::min(blockRows, usersView.Count - first);
+        accumulatedBalance += static_cast<double>(sumActiveBalances(
+            usersView.Subview(first, count), minimumBalance));
+    }
+
+    return accumulatedBalance;
+}
+
+/*******************************************************************************
+* Circular scan manager
+*******************************************************************************/
+
+/* Shared circular scan over the table. Scanner threads claim blocks in
+ * circular order from a single cursor; each claimed block is evaluated for
+ * every query attached at claim time while it is still hot in cache, so the
+ * memory traffic of a block is paid once for all of them. A query attaching
+ * at claim number k rides claims [k, k + blocksCount), which covers every
+ * block exactly once whatever position the cursor was at. */
+class CircularScanManager
+{
+public:
+    CircularScanManager(const SumActiveBalancesFn sumActiveBalances,
+                        const UsersView& usersView, const std::size_t blockRows,
+                        const std::size_t scannersCount)
+        : SumBlock(sumActiveBalances)
+        , Users(usersView)
+        , BlockRows(blockRows)
+        , BlocksCount((usersView.Count + blockRows - 1) / blockRows)
+    {
+        Scanners.reserve(scannersCount);
+        for (std::size_t i = 0; i < scannersCount; ++i) {
+            Scanners.emplace_back([this] { Scan(); });
+        }
+    }
+
+    ~CircularScanManager()
+    {
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            bStopping = true;
+        }
+        ScannersCondition.notify_all();
+
+        for (std::thread& scanner : Scanners) {
+            scanner.join();
+        }
+    }
+
+    CircularScanManager(const CircularScanManager&) = delete;
+    CircularScanManager& operator=(const CircularScanManager&) = delete;
+
+    /* Attaches to the scan in progress and blocks until it has wrapped around. */
+    double SumActiveBalances(const float minimumBalance)
+    {
+        AttachedQuery query{minimumBalance, 0, BlocksCount, 0.0, false};
+
+        std::unique_lock<std::mutex> lock{Mutex};
+        query.FirstClaim = NextClaim;
+        Attached.push_back(&query);
+        ScannersCondition.notify_all();
+
+        QueriesCondition.wait(lock, [&] { return query.bDone; });
+
+        return query.AccumulatedBalance;
+    }
+
+private:
+    struct AttachedQuery
+    {
+        float MinimumBalance;
+        uint64_t FirstClaim;
+        std::size_t BlocksRemaining;
+        double AccumulatedBalance;
+        bool bDone;
+    };
+
+    void Scan()
+    {
+        std::vector<AttachedQuery*> riders;
+        std::vector<double> partialBalances;
+
+        std::unique_lock<std::mutex> lock{Mutex};
+
+        for (;;) {
+            ScannersCondition.wait(lock, [&] {
+                return bStopping || !Attached.empty();
+            });
+            if (bStopping) {
+                break;
+            }
+
+            const uint64_t claim = NextClaim++;
+            const std::size_t block = static_cast<std::size_t>(claim % BlocksCount);
+
+            riders.clear();
+            for (std::size_t q = 0; q < Attached.size();) {
+                AttachedQuery* query = Attached[q];
+                riders.push_back(query);
+
+                if (claim + 1 == query->FirstClaim + BlocksCount) {
+                    Attached[q] = Attached.back();
+                    Attached.pop_back();
+                } else {
+                    ++q;
+                }
+            }
+
+            lock.unlock();
+
+            const std::size_t first = block * BlockRows;
+            const std::size_t count = std::min(BlockRows, Users.Count - first);
+
+            partialBalances.resize(riders.size());
+            for (std::size_t q = 0; q < riders.size(); ++q) {
+                partialBalances[q] = static_cast<double>(SumBlock(
+                    Users.Subview(first, count), riders[q]->MinimumBalance));
+            }
+
+            lock.lock();
+
+            bool bAnyDone = false;
+            for (std::size_t q = 0; q < riders.size(); ++q) {
+                riders[q]->AccumulatedBalance += partialBalances[q];
+                if (--riders[q]->BlocksRemaining == 0) {
+                    riders[q]->bDone = true;
+                    bAnyDone = true;
+                }
+            }
+
+            if (bAnyDone) {
+                QueriesCondition.notify_all();
+            }
+        }
+    }
+
+    SumActiveBalancesFn SumBlock;
+    UsersView Users;
+    std::size_t BlockRows;
+    std::size_t BlocksCount;
+
+    std::mutex Mutex;
+    std::condition_variable ScannersCondition;
+    std::condition_variable QueriesCondition;
+    std::vector<AttachedQuery*> Attached;
+    uint64_t NextClaim = 0;
+    bool bStopping = false;
+
+    std::vector<std::thread> Scanners;
+};
+
+/*******************************************************************************
+* Concurrent query driver
+*******************************************************************************/
+
+struct ThroughputResults
+{
+    double Checksum;
+    double TotalTimeSeconds;
+};
+
+/* Runs `queriesPerClient` queries on each of `clientsCount` threads and
+ * reports the wall time for all of them. */
+template <class F>
+ThroughputResults RunClients(const std::size_t clientsCount,
+                             const std::size_t queriesPerClient,
+                             const std::vector<float>& thresholds, F&& query)
+{
+    std::vector<double> checksums(clientsCount, 0.0);
+    std::vector<std::thread> clients;
+    clients.reserve(clientsCount);
+
+    const double totalTimeSeconds = MeasureExecutionTime(1, [&] {
+        for (std::size_t c = 0; c < clientsCount; ++c) {
+            clients.emplace_back([&, c] {
+                for (std::size_t q = 0; q < queriesPerClient; ++q) {
+                    const float minimumBalance =
+                        thresholds[(c * queriesPerClient + q) % thresholds.size()];
+                    checksums[c] += query(minimumBalance);
+                }
+            });
+        }
+
+        for (std::thread& client : clients) {
+            client.join();
+        }
+        return 0.0f;
+    });
+
+    double checksum = 0.0;
+    for (const double clientChecksum : checksums) {
+        checksum += clientChecksum;
+    }
+
+    return ThroughputResults{checksum, totalTimeSeconds};
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 100'000'000;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t blockRows = 32'768;
+    constexpr std::size_t queriesPerClient = 4;
+    constexpr std::size_t concurrencyLevels[] = {1, 2, 4, 8, 16, 32};
+
+    std::println("");
+    std::println("[ DoD Shared Scan Benchmark ]");
+    std::println("Elements Count     : {}", elementsCount);
+    std::println("Random Seed        : {}", randomSeed);
+    std::println("Block Rows         : {}", blockRows);
+    std::println("Queries per Client : {}", queriesPerClient);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    std::vector<float> thresholds;
+    std::uniform_real_distribution<float> thresholdDistribution{0.0f, 1000.0f};
+    for (std::size_t i = 0; i < 64; ++i) {
+        thresholds.push_back(thresholdDistribution(randomEngine));
+    }
+
+    /* Both strategies evaluate a block with the same kernel, so only the
+     * sharing differs between them. */
+    const SumActiveBalancesFn sumActiveBalances =
+        ResolveSumActiveBalances(EUsersKernel::Znver2);
+
+    std::println("");
+    std::println("Warming up...");
+
+    volatile double warmupChecksum =
+        SumActiveBalances(sumActiveBalances, usersView, blockRows, thresholds[0]);
+    (void)warmupChecksum;
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    std::println("");
+    std::println("[ Shared Scan Results ]");
+    std::println("{:>8} | {:>8} | {:>22} | {:>22} | {:>12} | {:>12} | {:>8}",
+                 "Clients", "Threads", "Independent Checksum", "Shared Checksum",
+                 "Independent", "Shared", "Speedup");
+    std::println("{:>8} | {:>8} | {:>22} | {:>22} | {:>12} | {:>12} | {:>8}",
+                 "", "", "", "", "Queries/s", "Queries/s", "");
+
+    for (const std::size_t clientsCount : concurrencyLevels) {
+        /* Independent queries scan on their clients' threads, so the shared
+         * scan gets one scanner per client: both sides run the same number
+         * of threads and the speedup is what sharing the blocks buys. */
+        const std::size_t scannersCount = clientsCount;
+
+        CircularScanManager scanManager{
+            sumActiveBalances, usersView, blockRows, scannersCount,
+        };
+
+        const ThroughputResults independent = RunClients(
+            clientsCount, queriesPerClient, thresholds,
+            [&](const float minimumBalance) {
+                return SumActiveBalances(
+                    sumActiveBalances, usersView, blockRows, minimumBalance);
+            });
+
+        const ThroughputResults shared = RunClients(
+            clientsCount, queriesPerClient, thresholds,
+            [&](const float minimumBalance) {
+                return scanManager.SumActiveBalances(minimumBalance);
+            });
+
+        const double queriesCount =
+            static_cast<double>(clientsCount * queriesPerClient);
+        const double independentThroughput =
+            queriesCount / independent.TotalTimeSeconds;
+        const double sharedThroughput = queriesCount / shared.TotalTimeSeconds;
+
+        std::println("{:>8} | {:>8} | {:>22.2f} | {:>22.2f} | {:>12.2f} | {:>12.2f} | {:>7.2f}x",
+                     clientsCount, scannersCount, independent.Checksum, shared.Checksum,
+                     independentThroughput, sharedThroughput,
+                     sharedThroughput / independentThroughput);
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/* One bit per user, LSB-first: bit (i % 8) of byte (i / 8) is user i. */
+struct UsersBitmapView
+{
+    const float* RESTRICT_ALIAS Balances;
+    const uint8_t* RESTRICT_ALIAS ActiveBits;
+    std::size_t Count;
+};
+
+/* Balances are non-negative, so the sign bit is free to carry the inverse of
+ * the active flag: an inactive user is stored as its negated balance. */
+struct SignedBalancesView
+{
+    const float* RESTRICT_ALIAS SignedBalances;
+    std::size_t Count;
+};
+
+constexpr uint32_t SignBit = 0x80000000u;
+
+[[nodiscard]] float EncodeSignedBalance(const float balance, const bool active)
+{
+    const uint32_t bits = std::bit_cast<uint32_t>(balance) & ~SignBit;
+    return std::bit_cast<float>(active ? bits : bits | SignBit);
+}
+
+[[nodiscard]] float DecodeBalance(const float signedBalance)
+{
+    return std::bit_cast<float>(std::bit_cast<uint32_t>(signedBalance) & ~SignBit);
+}
+
+[[nodiscard]] bool DecodeActive(const float signedBalance)
+{
+    return (std::bit_cast<uint32_t>(signedBalance) & SignBit) == 0;
+}
+
+FORCE_NOINLINE void EncodeSignedBalances(
+    const UsersView& usersView, float* RESTRICT_ALIAS signedBalances)
+{
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        const uint32_t bits = std::bit_cast<uint32_t>(usersView.Balances[i]);
+        const uint32_t inactiveBit = usersView.Active[i] ? 0u : SignBit;
+        signedBalances[i] = std::bit_cast<float>((bits & ~SignBit) | inactiveBit);
+    }
+}
+
+FORCE_NOINLINE void EncodeActiveBitmap(
+    const UsersView& usersView, uint8_t* RESTRICT_ALIAS activeBits)
+{
+    std::fill_n(activeBits, (usersView.Count + 7) / 8, uint8_t{0});
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        activeBits[i / 8] |= static_cast<uint8_t>(
+            (usersView.Active[i] ? 1u : 0u) << (i % 8));
+    }
+}
+
+/* Compares the raw bits as signed integers: for non-negative floats the
+ * integer order matches the float order, and every inactive (sign-set) value
+ * is negative, so `bits >= threshold bits` is the whole predicate. This also
+ * keeps -0.0 (an inactive zero balance) out when the threshold is zero. */
+[[nodiscard]] int32_t SignedThresholdBits(const float minimumBalance)
+{
+    return std::bit_cast<int32_t>(std::max(minimumBalance, 0.0f));
+}
+
+FORCE_NOINLINE float SumActiveBalancesSignedScalar(
+    const SignedBalancesView& signedView, const float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+    const int32_t thresholdBits = SignedThresholdBits(minimumBalance);
+
+    for (std::size_t i = 0; i < signedView.Count; ++i) {
+        const float signedBalance = signedView.SignedBalances[i];
+        const float takeValue =
+            std::bit_cast<int32_t>(signedBalance) >= thresholdBits ? 1.0f : 0.0f;
+        accumulatedBalance += signedBalance * takeValue;
+    }
+
+    return accumulatedBalance;
+}
+
+#if defined(__AVX2__)
+FORCE_NOINLINE float SumActiveBalancesBitmapAvx2(
+    const UsersBitmapView& bitmapView, float minimumBalance)
+{
+    const std::size_t count = bitmapView.Count;
+    const float* RESTRICT_ALIAS balances = bitmapView.Balances;
+    const std::uint8_t* RESTRICT_ALIAS activeBits = bitmapView.ActiveBits;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+    __m256 acc = _mm256_setzero_ps();
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n8; i += vectorWidth) {
+        __m256 b = _mm256_loadu_ps(&balances[i]);
+
+        __m256i bits = _mm256_set1_epi32(activeBits[i / vectorWidth]);
+        __m256i activeM = _mm256_cmpeq_epi32(
+            _mm256_and_si256(bits, laneBits), laneBits);
+
+        __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
+        __m256 take = _mm256_and_ps(cmpMask, _mm256_castsi256_ps(activeM));
+
+        acc = _mm256_add_ps(acc, _mm256_and_ps(b, take));
+    }
+
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    float accumulatedBalance = _mm_cvtss_f32(sum);
+
+    for (; i < count; ++i) {
+        const bool bActive = (activeBits[i / 8] >> (i % 8)) & 1u;
+        if (bActive && balances[i] >= minimumBalance) {
+            accumulatedBalance += balances[i];
+        }
+    }
+
+    return accumulatedBalance;
+}
+
+/* One stream, one compare, no mask building: the compare result masks the
+ * value directly, and qualifying values already carry a clear sign bit. */
+FORCE_NOINLINE float SumActiveBalancesSignedAvx2(
+    const SignedBalancesView& signedView, float minimumBalance)
+{
+    const std::size_t count = signedView.Count;
+    const float* RESTRICT_ALIAS signedBalances = signedView.SignedBalances;
+
+    const int32_t thresholdBits = SignedThresholdBits(minimumBalance);
+    const __m256i thresholdMinusOne = _mm256_set1_epi32(thresholdBits - 1);
+
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    constexpr std::size_t vectorWidth = 16;
+    const std::size_t n16 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n16; i += vectorWidth) {
+        __m256i v0 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(signedBalances + i));
+        __m256i take0 = _mm256_cmpgt_epi32(v0, thresholdMinusOne);
+        acc0 = _mm256_add_ps(acc0, _mm256_castsi256_ps(_mm256_and_si256(v0, take0)));
+
+        __m256i v1 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(signedBalances + i + 8));
+        __m256i take1 = _mm256_cmpgt_epi32(v1, thresholdMinusOne);
+        acc1 = _mm256_add_ps(acc1, _mm256_castsi256_ps(_mm256_and_si256(v1, take1)));
+    }
+
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    float accumulatedBalance = _mm_cvtss_f32(sum);
+
+    for (; i < count; ++i) {
+        if (std::bit_cast<int32_t>(signedBalances[i]) >= thresholdBits) {
+            accumulatedBalance += signedBalances[i];
+        }
+    }
+
+    return accumulatedBalance;
+}
+#endif  /* defined(__AVX2__) */
+
+struct VariantResults
+{
+    const char* Name;
+    double BytesPerUser;
+    float Checksum;
+    double AverageTimeSeconds;
+};
+
+template <class F>
+VariantResults MeasureVariant(const char* name, const double bytesPerUser,
+                              const std::size_t warmupIterations,
+                              const std::size_t iterations, F&& f)
+{
+    VariantResults results{name, bytesPerUser, 0.0f, 0.0};
+
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        results.Checksum = f();
+    }
+
+    results.AverageTimeSeconds =
+        MeasureExecutionTime(iterations, f) / static_cast<double>(iterations);
+
+    return results;
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+
+    std::println("");
+    std::println("[ DoD Signed Balance Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    std::println("");
+    std::println("Encoding columns...");
+
+    AlignedVector<float> signedBalances(elementsCount);
+    EncodeSignedBalances(usersView, signedBalances.data());
+
+    AlignedVector<uint8_t> activeBits((elementsCount + 7) / 8);
+    EncodeActiveBitmap(usersView, activeBits.data());
+
+    std::size_t roundTripMismatches = 0;
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        const bool bMatches =
+            DecodeBalance(signedBalances[i]) == usersView.Balances[i]
+            && DecodeActive(signedBalances[i]) == (usersView.Active[i] != 0)
+            && EncodeSignedBalance(usersView.Balances[i], usersView.Active[i] != 0)
+                == signedBalances[i];
+        roundTripMismatches += bMatches ? 0u : 1u;
+    }
+
+    const SignedBalancesView signedView{signedBalances.data(), elementsCount};
+    const UsersBitmapView bitmapView{
+        usersView.Balances, activeBits.data(), elementsCount,
+    };
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    const VariantResults variants[] = {
+        MeasureVariant("Byte Flags Scalar", 5.0,
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesScalar(usersView, minimumBalance);
+        }),
+        MeasureVariant("Signed Balance Scalar", 4.0,
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesSignedScalar(signedView, minimumBalance);
+        }),
+#if defined(__AVX2__)
+        MeasureVariant("Byte Flags AVX2", 5.0,
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesAvx2(usersView, minimumBalance);
+        }),
+        MeasureVariant("Bitmap AVX2", 4.125,
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesBitmapAvx2(bitmapView, minimumBalance);
+        }),
+        MeasureVariant("Signed Balance AVX2", 4.0,
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesSignedAvx2(signedView, minimumBalance);
+        }),
+#endif  /* defined(__AVX2__) */
+    };
+
+    std::println("");
+    std::println("[ Signed Balance Results ]");
+    std::println("Round Trip Mismatches : {}", roundTripMismatches);
+    std::println("");
+    std::println("{:<22} | {:>10} | {:>20} | {:>16}",
+                 "Variant", "Bytes/User", "Checksum", "ns per Element");
+
+    for (const VariantResults& variant : variants) {
+        std::println("{:<22} | {:>10.3f} | {:>20.2f} | {:>16.2f}",
+                     variant.Name, variant.BytesPerUser, variant.Checksum,
+                     (variant.AverageTimeSeconds * 1e9)
+                         / static_cast<double>(elementsCount));
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+#if defined(__AVX2__)
+/* Contribution of eight rows starting at `offset`, with the rows outside
+ * `lanes` zeroed. */
+inline __m256 ContributeAvx2(const float* RESTRICT_ALIAS balances,
+                             const uint8_t* RESTRICT_ALIAS activeFlags,
+                             const std::size_t offset, const __m256 threshold,
+                             const __m256 lanes)
+{
+    const __m256 b = _mm256_loadu_ps(balances + offset);
+    const __m256i flags = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + offset)));
+    const __m256 active = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(flags, _mm256_setzero_si256()));
+
+    const __m256 take = _mm256_and_ps(
+        _mm256_and_ps(_mm256_cmp_ps(b, threshold, _CMP_GE_OQ), active), lanes);
+
+    return _mm256_and_ps(b, take);
+}
+
+/* Horizontal sum with shuffles instead of two hadds, which are three uops
+ * each on Zen 2 and Intel alike. */
+inline float ReduceAddAvx2(const __m256 acc)
+{
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+
+/* Small-table kernel. Per call it avoids what the large-table kernel can
+ * amortize: the scalar tail, which is replaced by one more vector step
+ * over the last eight rows with the already summed lanes masked off; the
+ * hadd reduction; and the multiply, since a masked AND selects the balance
+ * directly. Tables under eight rows have no full window to overlap and go
+ * to the scalar loop. */
+FORCE_NOINLINE float SumActiveBalancesAvx2Small(
+    const UsersView& usersView, const float minimumBalance)
+{
+    constexpr std::size_t vectorWidth = 8;
+
+    const std::size_t count = usersView.Count;
+    if (count < vectorWidth) {
+        return SumActiveBalancesScalar(usersView, minimumBalance);
+    }
+
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256 allLanes = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    const std::size_t n16 = (count / (2 * vectorWidth)) * (2 * vectorWidth);
+
+    std::size_t i = 0;
+    for (; i < n16; i += 2 * vectorWidth) {
+        acc0 = _mm256_add_ps(acc0, ContributeAvx2(
+            balances, activeFlags, i, threshold, allLanes));
+        acc1 = _mm256_add_ps(acc1, ContributeAvx2(
+            balances, activeFlags, i + vectorWidth, threshold, allLanes));
+    }
+
+    if (count - i >= vectorWidth) {
+        acc0 = _mm256_add_ps(acc0, ContributeAvx2(
+            balances, activeFlags, i, threshold, allLanes));
+        i += vectorWidth;
+    }
+
+    /* Rows [i, count) are fewer than eight: load the last full window,
+     * [count - 8, count), and keep only its lanes at or past `i`. */
+    if (i < count) {
+        const int32_t skipped = static_cast<int32_t>(vectorWidth - (count - i));
+        const __m256 lanes = _mm256_castsi256_ps(_mm256_cmpgt_epi32(
+            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+            _mm256_set1_epi32(skipped - 1)));
+        acc1 = _mm256_add_ps(acc1, ContributeAvx2(
+            balances, activeFlags, count - vectorWidth, threshold, lanes));
+    }
+
+    return ReduceAddAvx2(_mm256_add_ps(acc0, acc1));
+}
+#endif  /* defined(__AVX2__) */
+
+/* The small-table kernel where the CPU has AVX2, resolved once like the
+ * library kernels. */
+SumActiveBalancesFn ResolveSumActiveBalancesSmall()
+{
+#if defined(__AVX2__)
+    if (ResolveSumActiveBalances(EUsersKernel::Avx2) == SumActiveBalancesAvx2) {
+        return SumActiveBalancesAvx2Small;
+    }
+#endif  /* defined(__AVX2__) */
+    return SumActiveBalancesScalar;
+}
+
+struct CallResults
+{
+    float Checksum;
+    double NanosecondsPerCall;
+};
+
+/* Calls `fn` on the tables round-robin, `callsCount` times in all, and
+ * returns the time per call. */
+template <class F>
+CallResults MeasureCalls(const std::span<const UsersView> tables,
+                         const std::size_t callsCount, const float minimumBalance,
+                         F&& fn)
+{
+    float checksum = 0.0f;
+
+    for (const UsersView& table : tables) {
+        checksum = fn(table, minimumBalance);
+    }
+
+    const double totalTimeSeconds = MeasureExecutionTime(1, [&] {
+        float sum = 0.0f;
+        for (std::size_t call = 0; call < callsCount; ++call) {
+            sum += fn(tables[call % tables.size()], minimumBalance);
+        }
+        return sum;
+    });
+
+    checksum = fn(tables[0], minimumBalance);
+
+    return CallResults{
+        checksum, totalTimeSeconds * 1e9 / static_cast<double>(callsCount),
+    };
+}
+
+int32_t main()
+{
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t tablesCount = 8;
+    constexpr std::size_t rowsPerSize = 1'000'000'000;
+
+    /* Odd sizes exercise the tail; the two below 1K show the fixed cost of
+     * a call on its own. */
+    constexpr std::array<std::size_t, 9> tableSizes{
+        64, 257, 1'000, 1'003, 4'096, 10'007, 16'384, 65'541, 100'000,
+    };
+
+    std::println("");
+    std::println("[ DoD Small Table Benchmark ]");
+    std::println("Table Sizes       : 64 to 100K");
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Tables per Size   : {}", tablesCount);
+    std::println("Rows per Size     : {}", rowsPerSize);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    const SumActiveBalancesFn resolvedLarge = ResolveSumActiveBalances();
+    const SumActiveBalancesFn resolvedSmall = ResolveSumActiveBalancesSmall();
+
+    struct SizeResults
+    {
+        std::size_t Rows;
+        std::size_t Calls;
+        CallResults Dispatched;
+        CallResults Resolved;
+        CallResults ResolvedSmall;
+        float ScalarChecksum;
+    };
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    std::vector<SizeResults> results;
+    for (const std::size_t rows : tableSizes) {
+        std::vector<UsersTable> tables(tablesCount);
+        std::vector<UsersView> views;
+
+        for (UsersTable& table : tables) {
+            GenerateUsers(table, rows, randomEngine);
+            views.push_back(MakeUsersView(table));
+        }
+
+        const std::size_t callsCount = std::max<std::size_t>(1'000, rowsPerSize / rows);
+
+        SizeResults result{
+            rows, callsCount,
+            MeasureCalls(views, callsCount, minimumBalance, SumActiveBalances),
+            MeasureCalls(views, callsCount, minimumBalance, resolvedLarge),
+            MeasureCalls(views, callsCount, minimumBalance, resolvedSmall),
+            SumActiveBalancesScalar(views[0], minimumBalance),
+        };
+
+        results.push_back(result);
+    }
+
+    /* Checksums are of the first table of each size; the reassociated AVX2
+     * sums differ from the scalar order in the last digits only. */
+    std::println("");
+    std::println("[ Small Table Results (ns per call) ]");
+    std::println("{:>7} | {:>9} | {:>13} | {:>13} | {:>13} | {:>8} | {:>14} | {:>14}",
+                 "Rows", "Calls", "Dispatched", "Resolved", "Resolved+Mask",
+                 "Speedup", "ns/Row (Disp)", "ns/Row (Mask)");
+
+    for (const SizeResults& result : results) {
+        std::println("{:>7} | {:>9} | {:>13.2f} | {:>13.2f} | {:>13.2f} | {:>7.2f}x | {:>14.4f} | {:>14.4f}",
+                     result.Rows, result.Calls,
+                     result.Dispatched.NanosecondsPerCall,
+                     result.Resolved.NanosecondsPerCall,
+                     result.ResolvedSmall.NanosecondsPerCall,
+                     result.Dispatched.NanosecondsPerCall
+                         / result.ResolvedSmall.NanosecondsPerCall,
+                     result.Dispatched.NanosecondsPerCall
+                         / static_cast<double>(result.Rows),
+                     result.ResolvedSmall.NanosecondsPerCall
+                         / static_cast<double>(result.Rows));
+    }
+
+    std::println("");
+    std::println("[ Checksums (first table) ]");
+    std::println("{:>7} | {:>14} | {:>14} | {:>14} | {:>14}",
+                 "Rows", "Scalar", "Dispatched", "Resolved", "Resolved+Mask");
+    for (const SizeResults& result : results) {
+        std::println("{:>7} | {:>14.2f} | {:>14.2f} | {:>14.2f} | {:>14.2f}",
+                     result.Rows, result.ScalarChecksum,
+                     result.Dispatched.Checksum, result.Resolved.Checksum,
+                     result.ResolvedSmall.Checksum);
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
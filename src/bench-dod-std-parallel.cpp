@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if __has_include(<execution>)
+#include <execution>
+#endif  /* __has_include(<execution>) */
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+#include "thread-pool.hpp"
+
+/*******************************************************************************
+* Standard parallel algorithms
+*******************************************************************************/
+
+/* The two-range transform_reduce is the standard way to zip the columns:
+ * the binary transform sees a balance and its flag side by side, with plain
+ * pointers as iterators. A zip view would do the same with proxy iterators,
+ * which the execution-policy overloads do not accept. */
+#if defined(__cpp_lib_execution) && __cpp_lib_execution >= 201902L
+FORCE_NOINLINE float SumActiveBalancesStdUnseq(
+    const UsersView& usersView, const float minimumBalance)
+{
+    return std::transform_reduce(
+        std::execution::unseq,
+        usersView.Balances, usersView.Balances + usersView.Count, usersView.Active,
+        0.0f, std::plus<>{},
+        [minimumBalance](const float balance, const uint8_t active) {
+            return (active && balance >= minimumBalance) ? balance : 0.0f;
+        });
+}
+#endif  /* defined(__cpp_lib_execution) && __cpp_lib_execution >= 201902L */
+
+/* libstdc++ runs the parallel policies on TBB. Built without it (the makefile
+ * defines _GLIBCXX_USE_TBB_PAR_BACKEND=0 when TBB does not link), it falls
+ * back to a serial backend and par_unseq runs on the calling thread only. */
+#if defined(__GLIBCXX__) && !_GLIBCXX_USE_TBB_PAR_BACKEND
+constexpr bool bStdParallelSerialBackend = true;
+#else   /* defined(__GLIBCXX__) && !_GLIBCXX_USE_TBB_PAR_BACKEND */
+constexpr bool bStdParallelSerialBackend = false;
+#endif  /* defined(__GLIBCXX__) && !_GLIBCXX_USE_TBB_PAR_BACKEND */
+
+#if defined(__cpp_lib_parallel_algorithm)
+FORCE_NOINLINE float SumActiveBalancesStdParUnseq(
+    const UsersView& usersView, const float minimumBalance)
+{
+    return std::transform_reduce(
+        std::execution::par_unseq,
+        usersView.Balances, usersView.Balances + usersView.Count, usersView.Active,
+        0.0f, std::plus<>{},
+        [minimumBalance](const float balance, const uint8_t active) {
+            return (active && balance >= minimumBalance) ? balance : 0.0f;
+        });
+}
+#endif  /* defined(__cpp_lib_parallel_algorithm) */
+
+/*******************************************************************************
+* OpenMP
+*******************************************************************************/
+
+#if defined(_OPENMP)
+FORCE_NOINLINE float SumActiveBalancesOpenMpSimd(
+    const UsersView& usersView, const float minimumBalance)
+{
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    float accumulatedBalance = 0.0f;
+
+#pragma omp simd reduction(+ : accumulatedBalance)
+    for (std::size_t i = 0; i < count; ++i) {
+        accumulatedBalance +=
+            (activeFlags[i] && balances[i] >= minimumBalance) ? balances[i] : 0.0f;
+    }
+
+    return accumulatedBalance;
+}
+
+FORCE_NOINLINE float SumActiveBalancesOpenMpParallel(
+    const int32_t threadsCount, const UsersView& usersView,
+    const float minimumBalance)
+{
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    float accumulatedBalance = 0.0f;
+
+#pragma omp parallel for simd num_threads(threadsCount) schedule(static) \
+    reduction(+ : accumulatedBalance)
+    for (std::size_t i = 0; i < count; ++i) {
+        accumulatedBalance +=
+            (activeFlags[i] && balances[i] >= minimumBalance) ? balances[i] : 0.0f;
+    }
+
+    return accumulatedBalance;
+}
+#endif  /* defined(_OPENMP) */
+
+/*******************************************************************************
+* Hand-written
+*******************************************************************************/
+
+/* One grain-aligned range per pool thread, each scanned by the resolved
+ * kernel, as in bench-repository-sharded. */
+FORCE_NOINLINE float SumActiveBalancesPool(
+    ThreadPool& pool, const SumActiveBalancesFn sumActiveBalances,
+    const UsersView& usersView, const float minimumBalance)
+{
+    constexpr std::size_t grainRows = 64;
+
+    std::vector<float> partialBalances(pool.GetThreadsCount(), 0.0f);
+
+    pool.ParallelForRange(usersView.Count, grainRows,
+                          [&](const std::size_t range, const std::size_t begin,
+                              const std::size_t end) {
+        partialBalances[range] = sumActiveBalances(
+            usersView.Subview(begin, end - begin), minimumBalance);
+    });
+
+    float accumulatedBalance = 0.0f;
+    for (const float partialBalance : partialBalances) {
+        accumulatedBalance += partialBalance;
+    }
+
+    return accumulatedBalance;
+}
+
+/*******************************************************************************
+* Measurement
+*******************************************************************************/
+
+struct VariantResults
+{
+    std::string Name;
+    bool bParallel;
+    float Checksum;
+    double AverageTimeSeconds;
+};
+
+template <class F>
+VariantResults MeasureVariant(std::string name, const bool bParallel,
+                              const std::size_t warmupIterations,
+                              const std::size_t iterations, F&& fn)
+{
+    float checksum = 0.0f;
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        checksum = fn();
+    }
+
+    const double totalTimeSeconds = MeasureExecutionTime(iterations, fn);
+
+    return VariantResults{
+        std::move(name), bParallel, checksum,
+        totalTimeSeconds / static_cast<double>(iterations),
+    };
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+
+    const std::size_t threadsCount =
+        std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+    std::println("");
+    std::println("[ DoD Standard Parallel Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Threads           : {}", threadsCount);
+#if defined(__cpp_lib_parallel_algorithm)
+    std::println("Parallel STL      : {}{}", __cpp_lib_parallel_algorithm,
+                 bStdParallelSerialBackend ? " (serial backend)" : "");
+#else   /* defined(__cpp_lib_parallel_algorithm) */
+    std::println("Parallel STL      : unavailable");
+#endif  /* defined(__cpp_lib_parallel_algorithm) */
+#if defined(_OPENMP)
+    std::println("OpenMP            : {}", _OPENMP);
+#else   /* defined(_OPENMP) */
+    std::println("OpenMP            : unavailable");
+#endif  /* defined(_OPENMP) */
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+    const SumActiveBalancesFn sumActiveBalances = ResolveSumActiveBalances();
+
+    ThreadPool pool{threadsCount};
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    /* The first serial and the first parallel row are the hand-written
+     * baselines the others are compared against. */
+    std::vector<VariantResults> results;
+
+    results.push_back(MeasureVariant(
+        "Hand-Written SIMD", false, warmupIterations, iterations, [&] {
+            return sumActiveBalances(usersView, minimumBalance);
+        }));
+    results.push_back(MeasureVariant(
+        "Scalar Loop", false, warmupIterations, iterations, [&] {
+            return SumActiveBalancesScalar(usersView, minimumBalance);
+        }));
+#if defined(__cpp_lib_execution) && __cpp_lib_execution >= 201902L
+    results.push_back(MeasureVariant(
+        "transform_reduce unseq", false, warmupIterations, iterations, [&] {
+            return SumActiveBalancesStdUnseq(usersView, minimumBalance);
+        }));
+#endif  /* defined(__cpp_lib_execution) && __cpp_lib_execution >= 201902L */
+#if defined(_OPENMP)
+    results.push_back(MeasureVariant(
+        "omp simd", false, warmupIterations, iterations, [&] {
+            return SumActiveBalancesOpenMpSimd(usersView, minimumBalance);
+        }));
+#endif  /* defined(_OPENMP) */
+
+    results.push_back(MeasureVariant(
+        "Hand-Written SIMD on Pool", true, warmupIterations, iterations, [&] {
+            return SumActiveBalancesPool(
+                pool, sumActiveBalances, usersView, minimumBalance);
+        }));
+#if defined(__cpp_lib_parallel_algorithm)
+    /* On the serial backend the row is a one-thread loop, so it is compared
+     * with the serial baseline rather than the pool. */
+    results.push_back(MeasureVariant(
+        bStdParallelSerialBackend ? "par_unseq (serial backend)"
+                                  : "transform_reduce par_unseq",
+        !bStdParallelSerialBackend, warmupIterations, iterations, [&] {
+            return SumActiveBalancesStdParUnseq(usersView, minimumBalance);
+        }));
+#endif  /* defined(__cpp_lib_parallel_algorithm) */
+#if defined(_OPENMP)
+    results.push_back(MeasureVariant(
+        "omp parallel for simd", true, warmupIterations, iterations, [&] {
+            return SumActiveBalancesOpenMpParallel(
+                static_cast<int32_t>(threadsCount), usersView, minimumBalance);
+        }));
+#endif  /* defined(_OPENMP) */
+
+    const double serialBaselineSeconds = results.front().AverageTimeSeconds;
+    const double parallelBaselineSeconds =
+        std::ranges::find_if(results, &VariantResults::bParallel)->AverageTimeSeconds;
+
+    constexpr double bytesPerElement = sizeof(float) + sizeof(uint8_t);
+
+    std::println("");
+    std::println("[ Standard Parallel Results ]");
+    std::println("{:<28} | {:>8} | {:>20} | {:>10} | {:>9} | {:>16}",
+                 "Variant", "Threads", "Checksum", "Time (ms)", "GB/s",
+                 "vs Hand-Written");
+
+    for (const VariantResults& result : results) {
+        const double baselineSeconds =
+            result.bParallel ? parallelBaselineSeconds : serialBaselineSeconds;
+
+        std::println("{:<28} | {:>8} | {:>20.2f} | {:>10.2f} | {:>9.2f} | {:>15.2f}x",
+                     result.Name, result.bParallel ? threadsCount : 1,
+                     result.Checksum, result.AverageTimeSeconds * 1e3,
+                     bytesPerElement * static_cast<double>(elementsCount)
+                         / result.AverageTimeSeconds / 1e9,
+                     result.AverageTimeSeconds / baselineSeconds);
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
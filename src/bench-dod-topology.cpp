@@ -0,0 +1,494 @@
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  /* defined(__linux__) */
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+#if defined(__linux__)
+
+/*******************************************************************************
+* Topology discovery
+*******************************************************************************/
+
+/* One logical CPU. `L3Domain` numbers the distinct L3 slices, which on Zen 2
+ * is one per CCX; `SmtIndex` is the CPU's position among its core's
+ * hardware threads, 0 for the first. */
+struct CpuInfo
+{
+    int32_t Cpu;
+    int32_t Package;
+    int32_t Core;
+    int32_t L3Domain;
+    int32_t SmtIndex;
+};
+
+struct CpuTopology
+{
+    std::vector<CpuInfo> Cpus;
+    std::size_t CoresCount = 0;
+    std::vector<std::string> L3CpuLists;
+};
+
+bool ReadTextFile(const std::string& path, std::string& text)
+{
+    std::ifstream file{path};
+    if (!file) {
+        return false;
+    }
+
+    std::getline(file, text);
+    return true;
+}
+
+/* Parses the kernel's CPU list format, e.g. "0-5,24-29". */
+std::vector<int32_t> ParseCpuList(const std::string_view text)
+{
+    std::vector<int32_t> cpus;
+
+    std::size_t position = 0;
+    while (position < text.size()) {
+        const std::size_t end = std::min(text.find(',', position), text.size());
+        const std::string range{text.substr(position, end - position)};
+
+        const std::size_t dash = range.find('-');
+        const int32_t first = std::atoi(range.c_str());
+        const int32_t last = dash == std::string::npos
+            ? first : std::atoi(range.c_str() + dash + 1);
+        for (int32_t cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+
+        position = end + 1;
+    }
+
+    return cpus;
+}
+
+/* Reads the topology of the CPUs this process may run on from sysfs. When
+ * a file is missing, the CPU is treated as its own core, with one L3 domain
+ * per package, so the policies still produce a valid, if uninformative,
+ * placement. */
+CpuTopology DiscoverTopology()
+{
+    CpuTopology topology;
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    std::map<std::pair<int32_t, int32_t>, int32_t> coreIndices;
+    std::map<std::string, int32_t> l3Domains;
+
+    for (int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+
+        const std::string base =
+            "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/";
+
+        std::string text;
+        const int32_t package =
+            ReadTextFile(base + "topology/physical_package_id", text)
+                ? std::atoi(text.c_str()) : 0;
+        const int32_t coreId = ReadTextFile(base + "topology/core_id", text)
+            ? std::atoi(text.c_str()) : cpu;
+
+        int32_t smtIndex = 0;
+        if (ReadTextFile(base + "topology/thread_siblings_list", text)) {
+            const std::vector<int32_t> siblings = ParseCpuList(text);
+            smtIndex = static_cast<int32_t>(
+                std::find(siblings.begin(), siblings.end(), cpu) - siblings.begin());
+        }
+
+        std::string l3CpuList = "package " + std::to_string(package);
+        for (int32_t index = 0; index < 16; ++index) {
+            const std::string cacheBase =
+                base + "cache/index" + std::to_string(index) + "/";
+            if (!ReadTextFile(cacheBase + "level", text)) {
+                break;
+            }
+            if (text == "3" && ReadTextFile(cacheBase + "shared_cpu_list", text)) {
+                l3CpuList = text;
+                break;
+            }
+        }
+
+        const auto [core, bNewCore] = coreIndices.try_emplace(
+            std::pair{package, coreId}, static_cast<int32_t>(coreIndices.size()));
+        const auto [domain, bNewDomain] = l3Domains.try_emplace(
+            l3CpuList, static_cast<int32_t>(l3Domains.size()));
+        if (bNewDomain) {
+            topology.L3CpuLists.push_back(l3CpuList);
+        }
+
+        topology.Cpus.push_back(CpuInfo{
+            cpu, package, core->second, domain->second, smtIndex,
+        });
+    }
+
+    topology.CoresCount = coreIndices.size();
+
+    return topology;
+}
+
+/*******************************************************************************
+* Placement policies
+*******************************************************************************/
+
+enum class EPlacementPolicy : uint8_t
+{
+    Unpinned,
+    Compact,
+    Scatter,
+    OnePerCcx,
+    NoSmt,
+};
+
+const char* GetPlacementPolicyName(const EPlacementPolicy policy)
+{
+    switch (policy) {
+    case EPlacementPolicy::Unpinned:  return "Unpinned";
+    case EPlacementPolicy::Compact:   return "Compact";
+    case EPlacementPolicy::Scatter:   return "Scatter";
+    case EPlacementPolicy::OnePerCcx: return "One per CCX";
+    case EPlacementPolicy::NoSmt:     return "No SMT";
+    }
+
+    return "Unknown";
+}
+
+/* Returns the CPU of every thread, -1 for an unpinned one:
+ * - Compact fills one L3 domain after another, SMT siblings next to each
+ *   other, so threads share as few L3 slices as possible.
+ * - Scatter deals first hardware threads round-robin across L3 domains,
+ *   using SMT siblings only once every core has a thread.
+ * - One per CCX runs one thread on the first core of every L3 domain.
+ * - No SMT is Compact restricted to the first hardware thread of each core.
+ * Every policy is capped to `threadsCount` threads and gets fewer when it
+ * can use fewer CPUs, as One per CCX does on parts with few L3 domains. */
+std::vector<int32_t> PlaceThreads(const CpuTopology& topology,
+                                  const EPlacementPolicy policy,
+                                  const std::size_t threadsCount)
+{
+    std::vector<CpuInfo> compact = topology.Cpus;
+    std::sort(compact.begin(), compact.end(), [](const CpuInfo& lhs, const CpuInfo& rhs) {
+        return std::tie(lhs.L3Domain, lhs.Core, lhs.SmtIndex)
+            < std::tie(rhs.L3Domain, rhs.Core, rhs.SmtIndex);
+    });
+
+    std::vector<int32_t> cpus;
+
+    switch (policy) {
+    case EPlacementPolicy::Unpinned:
+        cpus.assign(threadsCount, -1);
+        break;
+
+    case EPlacementPolicy::Compact:
+        for (const CpuInfo& info : compact) {
+            cpus.push_back(info.Cpu);
+        }
+        break;
+
+    case EPlacementPolicy::Scatter: {
+        std::vector<std::vector<int32_t>> domains(topology.L3CpuLists.size());
+        std::vector<int32_t> siblings;
+        for (const CpuInfo& info : compact) {
+            if (info.SmtIndex == 0) {
+                domains[static_cast<std::size_t>(info.L3Domain)].push_back(info.Cpu);
+            } else {
+                siblings.push_back(info.Cpu);
+            }
+        }
+
+        for (std::size_t round = 0; cpus.size() + siblings.size() < compact.size(); ++round) {
+            for (const std::vector<int32_t>& domain : domains) {
+                if (round < domain.size()) {
+                    cpus.push_back(domain[round]);
+                }
+            }
+        }
+        cpus.insert(cpus.end(), siblings.begin(), siblings.end());
+        break;
+    }
+
+    case EPlacementPolicy::OnePerCcx: {
+        int32_t lastDomain = -1;
+        for (const CpuInfo& info : compact) {
+            if (info.L3Domain != lastDomain && info.SmtIndex == 0) {
+                cpus.push_back(info.Cpu);
+                lastDomain = info.L3Domain;
+            }
+        }
+        break;
+    }
+
+    case EPlacementPolicy::NoSmt:
+        for (const CpuInfo& info : compact) {
+            if (info.SmtIndex == 0) {
+                cpus.push_back(info.Cpu);
+            }
+        }
+        break;
+    }
+
+    cpus.resize(std::min(cpus.size(), threadsCount));
+
+    return cpus;
+}
+
+/*******************************************************************************
+* Measurement
+*******************************************************************************/
+
+struct PlacementResults
+{
+    EPlacementPolicy Policy;
+    std::size_t Threads;
+    std::size_t L3DomainsUsed;
+    std::size_t PinFailures;
+    float Checksum;
+    double AverageTimeSeconds;
+};
+
+/* Runs one thread per entry of `cpus`. Ranges are assigned in L3 domain
+ * order, so all threads of one CCX scan one contiguous stretch of rows.
+ * Each thread pins itself first and then copies its range into columns it
+ * allocates, so its pages are first touched, and placed, from its own CPU.
+ * Iterations are released and collected with barriers, so the time covers
+ * only the scans. */
+PlacementResults RunPlacement(const CpuTopology& topology,
+                              const EPlacementPolicy policy,
+                              const std::vector<int32_t>& cpus,
+                              const UsersView& usersView,
+                              const float minimumBalance,
+                              const std::size_t warmupIterations,
+                              const std::size_t iterations)
+{
+    const std::size_t threadsCount = cpus.size();
+
+    std::vector<int32_t> domainOfCpu(CPU_SETSIZE, -1);
+    for (const CpuInfo& info : topology.Cpus) {
+        domainOfCpu[static_cast<std::size_t>(info.Cpu)] = info.L3Domain;
+    }
+
+    const auto domainOf = [&](const int32_t cpu) {
+        return cpu < 0 ? -1 : domainOfCpu[static_cast<std::size_t>(cpu)];
+    };
+
+    std::vector<std::size_t> rangeOfThread(threadsCount);
+    for (std::size_t thread = 0; thread < threadsCount; ++thread) {
+        rangeOfThread[thread] = thread;
+    }
+    std::stable_sort(rangeOfThread.begin(), rangeOfThread.end(),
+                     [&](const std::size_t lhs, const std::size_t rhs) {
+                         return domainOf(cpus[lhs]) < domainOf(cpus[rhs]);
+                     });
+
+    std::vector<bool> domainsUsed(topology.L3CpuLists.size(), false);
+    for (const int32_t cpu : cpus) {
+        if (cpu >= 0) {
+            domainsUsed[static_cast<std::size_t>(domainOf(cpu))] = true;
+        }
+    }
+
+    std::vector<float> partialBalances(threadsCount, 0.0f);
+    std::vector<uint8_t> pinFailures(threadsCount, 0);
+
+    std::barrier startBarrier{static_cast<std::ptrdiff_t>(threadsCount + 1)};
+    std::barrier doneBarrier{static_cast<std::ptrdiff_t>(threadsCount + 1)};
+
+    const std::size_t roundsCount = warmupIterations + iterations;
+    const SumActiveBalancesFn sumActiveBalances = ResolveSumActiveBalances();
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadsCount);
+
+    for (std::size_t rangeIndex = 0; rangeIndex < threadsCount; ++rangeIndex) {
+        const std::size_t thread = rangeOfThread[rangeIndex];
+
+        workers.emplace_back([&, thread, rangeIndex] {
+            const int32_t cpu = cpus[thread];
+            if (cpu >= 0) {
+                cpu_set_t cpuSet;
+                CPU_ZERO(&cpuSet);
+                CPU_SET(cpu, &cpuSet);
+                pinFailures[rangeIndex] =
+                    pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0
+                        ? 1u : 0u;
+            }
+
+            const std::size_t begin = usersView.Count * rangeIndex / threadsCount;
+            const std::size_t end = usersView.Count * (rangeIndex + 1) / threadsCount;
+
+            AlignedVector<int32_t> ids(
+                usersView.Ids + begin, usersView.Ids + end);
+            AlignedVector<float> balances(
+                usersView.Balances + begin, usersView.Balances + end);
+            AlignedVector<uint8_t> activeFlags(
+                usersView.Active + begin, usersView.Active + end);
+
+            const UsersView rangeView = MakeUsersView(ids, balances, activeFlags);
+
+            for (std::size_t round = 0; round < roundsCount; ++round) {
+                startBarrier.arrive_and_wait();
+                partialBalances[rangeIndex] = sumActiveBalances(rangeView, minimumBalance);
+                doneBarrier.arrive_and_wait();
+            }
+        });
+    }
+
+    double totalTimeSeconds = 0.0;
+    for (std::size_t round = 0; round < roundsCount; ++round) {
+        const std::chrono::time_point<std::chrono::steady_clock> start{
+            std::chrono::steady_clock::now()
+        };
+
+        startBarrier.arrive_and_wait();
+        doneBarrier.arrive_and_wait();
+
+        const std::chrono::time_point<std::chrono::steady_clock> end{
+            std::chrono::steady_clock::now()
+        };
+
+        if (round >= warmupIterations) {
+            totalTimeSeconds += std::chrono::duration<double>(end - start).count();
+        }
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    float checksum = 0.0f;
+    for (const float partialBalance : partialBalances) {
+        checksum += partialBalance;
+    }
+
+    return PlacementResults{
+        policy, threadsCount,
+        static_cast<std::size_t>(std::count(domainsUsed.begin(), domainsUsed.end(), true)),
+        static_cast<std::size_t>(std::count(pinFailures.begin(), pinFailures.end(), 1u)),
+        checksum,
+        totalTimeSeconds / static_cast<double>(iterations),
+    };
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+
+    const CpuTopology topology = DiscoverTopology();
+
+    /* Half the cores is where placement matters most: Compact can fit the
+     * threads into half the L3 slices and half the cores, while Scatter and
+     * No SMT cannot. */
+    const std::size_t threadsCount =
+        std::max<std::size_t>(1, topology.CoresCount / 2);
+
+    std::println("");
+    std::println("[ DoD Topology Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Threads           : {}", threadsCount);
+
+    std::println("");
+    std::println("[ Topology ]");
+    std::println("Logical CPUs               : {}", topology.Cpus.size());
+    std::println("Physical Cores             : {}", topology.CoresCount);
+    std::println("L3 Domains                 : {}", topology.L3CpuLists.size());
+    for (std::size_t domain = 0; domain < topology.L3CpuLists.size(); ++domain) {
+        std::println("L3 Domain {:<3}              : {}",
+                     domain, topology.L3CpuLists[domain]);
+    }
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    std::vector<PlacementResults> results;
+    for (const EPlacementPolicy policy : {
+             EPlacementPolicy::Unpinned, EPlacementPolicy::Compact,
+             EPlacementPolicy::Scatter, EPlacementPolicy::OnePerCcx,
+             EPlacementPolicy::NoSmt,
+         }) {
+        const std::vector<int32_t> cpus = PlaceThreads(topology, policy, threadsCount);
+        results.push_back(RunPlacement(topology, policy, cpus, usersView,
+                                       minimumBalance, warmupIterations, iterations));
+    }
+
+    constexpr double bytesPerUser = sizeof(float) + sizeof(uint8_t);
+
+    std::println("");
+    std::println("[ Placement Results ]");
+    std::println("{:<12} | {:>7} | {:>8} | {:>12} | {:>20} | {:>10} | {:>10} | {:>12} | {:>8}",
+                 "Policy", "Threads", "L3 Used", "Pin Failures", "Checksum",
+                 "Time (ms)", "GB/s", "GB/s/Thread", "M Elem/s");
+
+    /* GB/s per thread keeps policies comparable when one of them runs fewer
+     * threads than the rest. */
+    for (const PlacementResults& result : results) {
+        const double gigabytesPerSecond =
+            static_cast<double>(elementsCount) * bytesPerUser
+                / result.AverageTimeSeconds / 1e9;
+
+        std::println("{:<12} | {:>7} | {:>8} | {:>12} | {:>20.2f} | {:>10.2f} | {:>10.2f} | {:>12.2f} | {:>8.2f}",
+                     GetPlacementPolicyName(result.Policy), result.Threads,
+                     result.L3DomainsUsed, result.PinFailures, result.Checksum,
+                     result.AverageTimeSeconds * 1e3, gigabytesPerSecond,
+                     gigabytesPerSecond / static_cast<double>(result.Threads),
+                     static_cast<double>(elementsCount)
+                         / result.AverageTimeSeconds / 1e6);
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
+
+#else   /* defined(__linux__) */
+
+int32_t main()
+{
+    std::println("The topology benchmark requires Linux sysfs and thread affinity.");
+    return EXIT_FAILURE;
+}
+
+#endif  /* defined(__linux__) */
@@ -4,129 +4,13 @@
 #include <cstdlib>
 #include <print>
 #include <random>
+#include <span>
 #include <string>
 #include <vector>
 
-#include <immintrin.h>
-
+#include "dod-users.hpp"
 #include "lib.hpp"
 
-struct UsersView
-{
-    const int32_t* RESTRICT_ALIAS Ids;
-    const float* RESTRICT_ALIAS Balances;
-    const uint8_t* RESTRICT_ALIAS Active;
-    std::size_t Count;
-};
-
-FORCE_NOINLINE float SumActiveBalancesScalar(
-    const UsersView &usersView, const float minimumBalance)
-{
-    float accumulatedBalance = 0.0f;
-    const float thresholdBalance = minimumBalance;
-
-    for (std::size_t i = 0; i < usersView.Count; ++i) {
-        const float balanceValue = usersView.Balances[i];
-        const float takeValue =
-            (usersView.Active[i] && balanceValue >= thresholdBalance)
-                ? 1.0f : 0.0f;
-        accumulatedBalance += balanceValue * takeValue;
-    }
-
-    return accumulatedBalance;
-}
-
-#if defined(__AVX2__)
-FORCE_NOINLINE float SumActiveBalancesAvx2(
-    const UsersView& usersView, float minimumBalance)
-{
-    const std::size_t count = usersView.Count;
-    const float* RESTRICT_ALIAS balances = usersView.Balances;
-    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
-
-    const __m256 threshold = _mm256_set1_ps(minimumBalance);
-    const __m256 one = _mm256_set1_ps(1.0f);
-
-    __m256d acc0 = _mm256_setzero_pd();
-    __m256d acc1 = _mm256_setzero_pd();
-    __m256d acc2 = _mm256_setzero_pd();
-    __m256d acc3 = _mm256_setzero_pd();
-
-    constexpr int32_t prefetchDistance = 256;
-
-    constexpr std::size_t vectorWidth = 16;
-    const std::size_t n16 = (count / vectorWidth) * vectorWidth;
-
-    std::size_t i = 0;
-    for (; i < n16; i += vectorWidth) {
-        _mm_prefetch(reinterpret_cast<const char*>(balances + i) + prefetchDistance, _MM_HINT_T0);
-        _mm_prefetch(reinterpret_cast<const char*>(activeFlags + i) + prefetchDistance, _MM_HINT_T0);
-
-        __m256 b0 = _mm256_loadu_ps(balances + i);
-        __m128i a8_0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i));
-        __m256i a32_0 = _mm256_cvtepu8_epi32(a8_0);
-        __m256 active0 = _mm256_min_ps(_mm256_cvtepi32_ps(a32_0), one);
-
-        __m256 cmp0 = _mm256_cmp_ps(b0, threshold, _CMP_GE_OQ);
-        __m256 contrib0 = _mm256_mul_ps(b0, _mm256_and_ps(cmp0, active0));
-
-        __m128 low0 = _mm256_castps256_ps128(contrib0);
-        __m128 high0 = _mm256_extractf128_ps(contrib0, 1);
-
-        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(low0));
-        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(high0));
-
-        __m256 b1 = _mm256_loadu_ps(balances + i + 8);
-        __m128i a8_1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i + 8));
-        __m256i a32_1 = _mm256_cvtepu8_epi32(a8_1);
-        __m256 active1 = _mm256_min_ps(_mm256_cvtepi32_ps(a32_1), one);
-
-        __m256 cmp1 = _mm256_cmp_ps(b1, threshold, _CMP_GE_OQ);
-        __m256 contrib1 = _mm256_mul_ps(b1, _mm256_and_ps(cmp1, active1));
-
-        __m128 low1 = _mm256_castps256_ps128(contrib1);
-        __m128 high1 = _mm256_extractf128_ps(contrib1, 1);
-
-        acc2 = _mm256_add_pd(acc2, _mm256_cvtps_pd(low1));
-        acc3 = _mm256_add_pd(acc3, _mm256_cvtps_pd(high1));
-    }
-
-    __m256d acc01 = _mm256_add_pd(acc0, acc1);
-    __m256d acc23 = _mm256_add_pd(acc2, acc3);
-    __m256d acc = _mm256_add_pd(acc01, acc23);
-
-    __m128d low = _mm256_castpd256_pd128(acc);
-    __m128d high = _mm256_extractf128_pd(acc, 1);
-    __m128d sum = _mm_add_pd(low, high);
-
-    double accumulatedBalance =
-        _mm_cvtsd_f64(sum) + _mm_cvtsd_f64(_mm_unpackhi_pd(sum, sum));
-
-    for (; i < count; ++i) {
-        if (activeFlags[i] && balances[i] >= minimumBalance) {
-            accumulatedBalance += static_cast<double>(balances[i]);
-        }
-    }
-
-    return accumulatedBalance;
-}
-#endif  /* defined(__AVX2__) */
-
-FORCE_NOINLINE float SumActiveBalances(
-    const UsersView &usersView, const float minimumBalance)
-{
-#if defined(__AVX2__)
-#if COMPILER_CLANG || COMPILER_GCC
-    if (__builtin_cpu_supports("avx2")) {
-        return SumActiveBalancesAvx2(usersView, minimumBalance);
-    }
-#endif  /* COMPILER_CLANG || COMPILER_GCC */
-    return SumActiveBalancesScalar(usersView, minimumBalance);
-#else  /* defined(__AVX2__) */
-    return SumActiveBalancesScalar(usersView, minimumBalance);
-#endif  /* defined(__AVX2__) */
-}
-
 int32_t main()
 {
     constexpr std::size_t elementsCount = 1'000'000'000;
@@ -144,35 +28,23 @@ int32_t main()
     std::println("Iterations        : {}", iterations);
 
     std::mt19937 randomEngine{randomSeed};
-    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
-    std::bernoulli_distribution           activeDistribution{0.6};
 
     std::println("");
     std::println("Generating elements...");
 
-    std::vector<std::int32_t> userIds(elementsCount);
-    std::vector<float> userBalances(elementsCount);
-    std::vector<std::uint8_t> userActiveFlags(elementsCount);
-
-    for (std::size_t i = 0; i < elementsCount; ++i) {
-        userIds[i] = static_cast<std::int32_t>(i);
-        userBalances[i] = balanceDistribution(randomEngine);
-        userActiveFlags[i] = activeDistribution(randomEngine) ? 1u : 0u;
-    }
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
 
-    UsersView usersView{
-        userIds.data(),
-        userBalances.data(),
-        userActiveFlags.data(),
-        elementsCount,
-    };
+    const UsersView usersView = MakeUsersView(users);
+    const SumActiveBalancesDoubleFn sumActiveBalances =
+        ResolveSumActiveBalancesDouble(EUsersKernel::Znver2);
 
     std::println("");
     std::println("Warming up...");
 
     double checksum = 0.0;
     for (std::size_t i = 0; i < warmupIterations; ++i) {
-        checksum = SumActiveBalances(usersView, minimumBalance);
+        checksum = sumActiveBalances(usersView, minimumBalance);
     }
 
     std::println("");
@@ -180,7 +52,7 @@ int32_t main()
 
     const double totalTimeSeconds = MeasureExecutionTime(
         iterations, [&] {
-            return SumActiveBalances(usersView, minimumBalance);
+            return sumActiveBalances(usersView, minimumBalance);
         });
 
     const double averageTimeSeconds = totalTimeSeconds / iterations;
@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+struct User
+{
+    int32_t Id;
+    float Balance;
+    bool Active;
+};
+
+/* The AoS SIMD kernels address the records as a flat array of 32-bit words,
+ * three per user: [Id, Balance, Active + padding]. */
+static_assert(sizeof(User) == 3 * sizeof(float), "User must be 12 bytes");
+static_assert(offsetof(User, Balance) == 1 * sizeof(float),
+              "User::Balance must be the second word");
+static_assert(offsetof(User, Active) == 2 * sizeof(float),
+              "User::Active must start the third word");
+
+struct IUserRepository
+{
+    virtual ~IUserRepository() = default;
+    virtual void ForEach(const std::function<void(const User&)>& fn) const = 0;
+    virtual std::optional<User> FindById(int32_t id) const = 0;
+};
+
+class VectorUserRepository final : public IUserRepository
+{
+public:
+    explicit VectorUserRepository(const std::vector<User>& users)
+        : Users(users)
+    {
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (const User& user : Users) {
+            fn(user);
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        for (const User& user : Users) {
+            if (user.Id == id) {
+                return user;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    /* Fast path for AoS-bound callers: the SIMD kernels below run straight
+     * on the stored records, without migrating them to columns. */
+    std::span<const User> GetUsers() const
+    {
+        return Users;
+    }
+
+private:
+    std::vector<User> Users;
+};
+
+[[nodiscard]] bool Qualifies(const User& user, const float minimumBalance)
+{
+    const bool bQualifies = user.Active && user.Balance >= minimumBalance;
+    return bQualifies;
+}
+
+FORCE_NOINLINE float SumActiveBalances(
+    const IUserRepository& repository, float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    repository.ForEach([&](const User& user) {
+        if (Qualifies(user, minimumBalance)){
+             accumulatedBalance += user.Balance;
+        }
+    });
+
+    return accumulatedBalance;
+}
+
+FORCE_NOINLINE float SumActiveBalancesAos(
+    const std::span<const User> users, const float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    for (const User& user : users) {
+        const float takeValue =
+            (user.Active && user.Balance >= minimumBalance) ? 1.0f : 0.0f;
+        accumulatedBalance += user.Balance * takeValue;
+    }
+
+    return accumulatedBalance;
+}
+
+#if defined(__AVX2__)
+[[nodiscard]] float HorizontalSum(const __m256 acc)
+{
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+
+    return _mm_cvtss_f32(sum);
+}
+
+/* Only the low byte of the Active word is the bool; the rest is padding whose
+ * value is unspecified, so it is masked off before testing for non-zero. */
+[[nodiscard]] __m256 TakeMask(const __m256 balances, const __m256i activeWords,
+                              const __m256 threshold)
+{
+    const __m256i activeByte =
+        _mm256_and_si256(activeWords, _mm256_set1_epi32(0xFF));
+    const __m256i activeM =
+        _mm256_cmpgt_epi32(activeByte, _mm256_setzero_si256());
+    const __m256 cmpMask = _mm256_cmp_ps(balances, threshold, _CMP_GE_OQ);
+
+    return _mm256_and_ps(cmpMask, _mm256_castsi256_ps(activeM));
+}
+
+FORCE_NOINLINE float SumActiveBalancesAosGatherAvx2(
+    const std::span<const User> users, float minimumBalance)
+{
+    const std::size_t count = users.size();
+    const float* RESTRICT_ALIAS words =
+        reinterpret_cast<const float*>(users.data());
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256i recordOffsets =
+        _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+    __m256 acc = _mm256_setzero_ps();
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n8; i += vectorWidth) {
+        const float* record = words + i * 3;
+
+        __m256 b = _mm256_i32gather_ps(record + 1, recordOffsets, 4);
+        __m256i a = _mm256_i32gather_epi32(
+            reinterpret_cast<const int*>(record + 2), recordOffsets, 4);
+
+        __m256 take = TakeMask(b, a, threshold);
+        acc = _mm256_add_ps(acc, _mm256_and_ps(b, take));
+    }
+
+    float accumulatedBalance = HorizontalSum(acc);
+
+    for (; i < count; ++i) {
+        if (Qualifies(users[i], minimumBalance)) {
+            accumulatedBalance += users[i].Balance;
+        }
+    }
+
+    return accumulatedBalance;
+}
+
+/* Eight records are 24 words, i.e. exactly three 256-bit loads. The eight
+ * Balance words sit at positions 1, 4, ..., 22 and land in distinct lanes
+ * (position % 8), as do the Active words at 2, 5, ..., 23, so two blends
+ * gather each field into one register and a lane permute orders it. */
+FORCE_NOINLINE float SumActiveBalancesAosShuffleAvx2(
+    const std::span<const User> users, float minimumBalance)
+{
+    const std::size_t count = users.size();
+    const float* RESTRICT_ALIAS words =
+        reinterpret_cast<const float*>(users.data());
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256i balanceOrder = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+    const __m256i activeOrder = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+
+    __m256 acc = _mm256_setzero_ps();
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n8; i += vectorWidth) {
+        const float* record = words + i * 3;
+
+        __m256 w0 = _mm256_loadu_ps(record);
+        __m256 w1 = _mm256_loadu_ps(record + 8);
+        __m256 w2 = _mm256_loadu_ps(record + 16);
+
+        /* Balance: lanes 1, 4, 7 of w0; 2, 5 of w1; 0, 3, 6 of w2. */
+        __m256 b = _mm256_blend_ps(_mm256_blend_ps(w0, w1, 0x24), w2, 0x49);
+        b = _mm256_permutevar8x32_ps(b, balanceOrder);
+
+        /* Active: lanes 2, 5 of w0; 0, 3, 6 of w1; 1, 4, 7 of w2. */
+        __m256 a = _mm256_blend_ps(_mm256_blend_ps(w0, w1, 0x49), w2, 0x92);
+        a = _mm256_permutevar8x32_ps(a, activeOrder);
+
+        __m256 take = TakeMask(b, _mm256_castps_si256(a), threshold);
+        acc = _mm256_add_ps(acc, _mm256_and_ps(b, take));
+    }
+
+    float accumulatedBalance = HorizontalSum(acc);
+
+    for (; i < count; ++i) {
+        if (Qualifies(users[i], minimumBalance)) {
+            accumulatedBalance += users[i].Balance;
+        }
+    }
+
+    return accumulatedBalance;
+}
+
+#endif  /* defined(__AVX2__) */
+
+struct VariantResults
+{
+    const char* Name;
+    std::size_t BytesPerUser;
+    float Checksum;
+    double AverageTimeSeconds;
+};
+
+template <class F>
+VariantResults MeasureVariant(const char* name, const std::size_t bytesPerUser,
+                              const std::size_t warmupIterations,
+                              const std::size_t iterations, F&& f)
+{
+    VariantResults results{name, bytesPerUser, 0.0f, 0.0};
+
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        results.Checksum = f();
+    }
+
+    results.AverageTimeSeconds =
+        MeasureExecutionTime(iterations, f) / static_cast<double>(iterations);
+
+    return results;
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+
+    std::println("");
+    std::println("[ AoS SIMD Repository Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable table;
+    GenerateUsers(table, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(table);
+
+    /* The repository holds the same users as the columns, as records. */
+    std::vector<User> users;
+    users.reserve(elementsCount);
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        users.push_back(User{
+            usersView.Ids[i],
+            usersView.Balances[i],
+            usersView.Active[i] != 0,
+        });
+    }
+
+    VectorUserRepository repository{users};
+    const std::span<const User> records = repository.GetUsers();
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    const VariantResults variants[] = {
+        MeasureVariant("Repository ForEach", sizeof(User),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalances(repository, minimumBalance);
+        }),
+        MeasureVariant("AoS Loop", sizeof(User),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesAos(records, minimumBalance);
+        }),
+#if defined(__AVX2__)
+        MeasureVariant("AoS Gather AVX2", sizeof(User),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesAosGatherAvx2(records, minimumBalance);
+        }),
+        MeasureVariant("AoS Shuffle AVX2", sizeof(User),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesAosShuffleAvx2(records, minimumBalance);
+        }),
+        MeasureVariant("SoA AVX2", sizeof(float) + sizeof(uint8_t),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesAvx2(usersView, minimumBalance);
+        }),
+#endif  /* defined(__AVX2__) */
+    };
+
+    const auto nanosecondsPerElement = [&](const VariantResults& variant) {
+        return (variant.AverageTimeSeconds * 1e9)
+            / static_cast<double>(elementsCount);
+    };
+
+    std::println("");
+    std::println("[ AoS SIMD Results ]");
+    std::println("{:<20} | {:>10} | {:>20} | {:>16}",
+                 "Variant", "Bytes/User", "Checksum", "ns per Element");
+
+    for (const VariantResults& variant : variants) {
+        std::println("{:<20} | {:>10} | {:>20.2f} | {:>16.2f}",
+                     variant.Name, variant.BytesPerUser, variant.Checksum,
+                     nanosecondsPerElement(variant));
+    }
+
+#if defined(__AVX2__)
+    /* Repository -> AoS loop is pure abstraction; AoS loop -> best AoS SIMD
+     * is what vectorizing the records buys; best AoS SIMD -> SoA AVX2 is
+     * what is left for the layout itself. */
+    const double repositoryNs = nanosecondsPerElement(variants[0]);
+    const double aosLoopNs = nanosecondsPerElement(variants[1]);
+    const double aosSimdNs = std::min(nanosecondsPerElement(variants[2]),
+                                      nanosecondsPerElement(variants[3]));
+    const double soaSimdNs = nanosecondsPerElement(variants[4]);
+
+    std::println("");
+    std::println("[ Gap Breakdown (Nanoseconds per Element) ]");
+    std::println("Abstraction (Repository - AoS Loop)   : {:.2f}",
+                 repositoryNs - aosLoopNs);
+    std::println("Vectorization (AoS Loop - AoS SIMD)   : {:.2f}",
+                 aosLoopNs - aosSimdNs);
+    std::println("Layout (AoS SIMD - SoA AVX2)          : {:.2f}",
+                 aosSimdNs - soaSimdNs);
+#endif  /* defined(__AVX2__) */
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
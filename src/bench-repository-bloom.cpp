@@ -0,0 +1,441 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "lib.hpp"
+#include "soa-table.hpp"
+
+struct User
+{
+    int32_t Id;
+    float Balance;
+    bool Active;
+};
+
+struct IUserRepository
+{
+    virtual ~IUserRepository() = default;
+    virtual void ForEach(const std::function<void(const User&)>& fn) const = 0;
+    virtual std::optional<User> FindById(int32_t id) const = 0;
+};
+
+class VectorUserRepository final : public IUserRepository
+{
+public:
+    explicit VectorUserRepository(const std::vector<User>& users)
+        : Users(users)
+    {
+    }
+
+    explicit VectorUserRepository(std::vector<User>&& users) noexcept
+        : Users(std::move(users))
+    {
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (const User& user : Users) {
+            fn(user);
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        for (const User& user : Users) {
+            if (user.Id == id) {
+                return user;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    std::vector<User> Users;
+};
+
+/* Records plus an id index: the ids sorted, with the row of each id
+ * alongside, searched with std::lower_bound. */
+class IndexedUserRepository final : public IUserRepository
+{
+public:
+    explicit IndexedUserRepository(std::vector<User>&& users)
+        : Users(std::move(users))
+        , SortedIds(Users.size())
+        , Rows(Users.size())
+    {
+        std::vector<std::pair<int32_t, uint32_t>> index(Users.size());
+        for (std::size_t i = 0; i < Users.size(); ++i) {
+            index[i] = {Users[i].Id, static_cast<uint32_t>(i)};
+        }
+        std::sort(index.begin(), index.end());
+
+        for (std::size_t i = 0; i < index.size(); ++i) {
+            SortedIds[i] = index[i].first;
+            Rows[i] = index[i].second;
+        }
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (const User& user : Users) {
+            fn(user);
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        const auto it = std::lower_bound(SortedIds.begin(), SortedIds.end(), id);
+        if (it == SortedIds.end() || *it != id) {
+            return std::nullopt;
+        }
+
+        return Users[Rows[static_cast<std::size_t>(it - SortedIds.begin())]];
+    }
+
+private:
+    std::vector<User> Users;
+    AlignedVector<int32_t> SortedIds;
+    std::vector<uint32_t> Rows;
+};
+
+/* Split-block Bloom filter: every key maps to one 256-bit block, and sets
+ * one bit in each of the block's eight 32-bit words. Blocks are 32-byte
+ * aligned, so they never straddle a cache line, and a query is one block
+ * load compared against a mask built with a single multiply and variable
+ * shift. A negative answer therefore costs one cache miss at most. */
+class BlockedBloomFilter
+{
+public:
+    static constexpr std::size_t BlockWords = 8;
+    static constexpr std::size_t BitsPerKey = 16;
+
+    explicit BlockedBloomFilter(const std::size_t keysCount)
+        : BlocksCount(std::max<std::size_t>(
+              1, (keysCount * BitsPerKey + BlockWords * 32 - 1) / (BlockWords * 32)))
+        , Words(BlocksCount * BlockWords, 0u)
+    {
+    }
+
+    void Insert(const int32_t key)
+    {
+        const uint64_t hash = HashKey(key);
+        uint32_t* RESTRICT_ALIAS block = Words.data() + BlockOf(hash) * BlockWords;
+
+        for (std::size_t i = 0; i < BlockWords; ++i) {
+            block[i] |= BitOf(hash, i);
+        }
+    }
+
+    bool MayContain(const int32_t key) const
+    {
+        const uint64_t hash = HashKey(key);
+        const uint32_t* RESTRICT_ALIAS block =
+            Words.data() + BlockOf(hash) * BlockWords;
+
+#if defined(__AVX2__)
+        const __m256i salts =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Salts.data()));
+        const __m256i shifts = _mm256_srli_epi32(
+            _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int32_t>(hash)), salts),
+            27);
+        const __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+        const __m256i words =
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+
+        return _mm256_testc_si256(words, mask) != 0;
+#else   /* defined(__AVX2__) */
+        for (std::size_t i = 0; i < BlockWords; ++i) {
+            if ((block[i] & BitOf(hash, i)) == 0) {
+                return false;
+            }
+        }
+
+        return true;
+#endif  /* defined(__AVX2__) */
+    }
+
+    std::size_t GetSizeBytes() const
+    {
+        return Words.size() * sizeof(uint32_t);
+    }
+
+private:
+    static constexpr std::array<uint32_t, BlockWords> Salts{
+        0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+        0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+    };
+
+    static uint64_t HashKey(const int32_t key)
+    {
+        uint64_t x = static_cast<uint32_t>(key);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+
+    /* Upper half of the hash picks the block by multiply-shift, so the
+     * block count need not be a power of two; the lower half feeds the
+     * per-word bits. */
+    std::size_t BlockOf(const uint64_t hash) const
+    {
+        return static_cast<std::size_t>(
+            ((hash >> 32) * static_cast<uint64_t>(BlocksCount)) >> 32);
+    }
+
+    static uint32_t BitOf(const uint64_t hash, const std::size_t word)
+    {
+        return 1u << ((static_cast<uint32_t>(hash) * Salts[word]) >> 27);
+    }
+
+    std::size_t BlocksCount;
+    AlignedVector<uint32_t> Words;
+};
+
+/* Decorator that answers FindById misses from a Bloom filter of the inner
+ * repository's ids and forwards everything else. The filter is built once
+ * from the inner repository, so, like the records it mirrors, it assumes
+ * the repository is not written to afterwards. */
+class BloomFilteredUserRepository final : public IUserRepository
+{
+public:
+    BloomFilteredUserRepository(const IUserRepository& inner,
+                                const std::size_t usersCount)
+        : Inner(inner)
+        , Filter(usersCount)
+    {
+        Inner.ForEach([&](const User& user) {
+            Filter.Insert(user.Id);
+        });
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        Inner.ForEach(fn);
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        if (!Filter.MayContain(id)) {
+            return std::nullopt;
+        }
+
+        return Inner.FindById(id);
+    }
+
+    const BlockedBloomFilter& GetFilter() const
+    {
+        return Filter;
+    }
+
+private:
+    const IUserRepository& Inner;
+    BlockedBloomFilter Filter;
+};
+
+struct LookupResults
+{
+    std::size_t Hits;
+    double NanosecondsPerLookup;
+};
+
+FORCE_NOINLINE LookupResults BenchmarkFindById(const IUserRepository& repository,
+                                               const std::span<const int32_t> probes,
+                                               const std::size_t iterations)
+{
+    std::size_t hits = 0;
+
+    const double totalTimeSeconds = MeasureExecutionTime(iterations, [&] {
+        hits = 0;
+        float balance = 0.0f;
+        for (const int32_t probe : probes) {
+            if (const std::optional<User> user = repository.FindById(probe)) {
+                ++hits;
+                balance += user->Balance;
+            }
+        }
+        return balance;
+    });
+
+    return LookupResults{
+        hits,
+        totalTimeSeconds * 1e9 / static_cast<double>(iterations * probes.size()),
+    };
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t iterations = 4;
+    constexpr std::size_t indexLookupsCount = 1'000'000;
+    constexpr std::size_t scanLookupsCount = 32;
+    constexpr double deletedRate = 0.05;
+    constexpr std::array<double, 5> missRatios{0.0, 0.25, 0.5, 0.9, 0.99};
+
+    std::println("");
+    std::println("[ Repository Bloom Filter Benchmark ]");
+    std::println("Elements Count      : {}", elementsCount);
+    std::println("Random Seed         : {}", randomSeed);
+    std::println("Iterations          : {}", iterations);
+    std::println("Index Lookups Count : {}", indexLookupsCount);
+    std::println("Scan Lookups Count  : {}", scanLookupsCount);
+    std::println("Deleted Id Rate     : {:.2f} %", deletedRate * 100.0);
+    std::println("Filter Bits per Key : {}", BlockedBloomFilter::BitsPerKey);
+
+    std::mt19937 randomEngine{randomSeed};
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+    std::bernoulli_distribution           activeDistribution{0.6};
+    std::bernoulli_distribution           deletedDistribution{deletedRate};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    /* Ids are issued sequentially and some users have since been deleted,
+     * so misses come both from deleted ids and from ids never issued. */
+    std::vector<User> users;
+    users.reserve(elementsCount);
+    for (int32_t id = 0; users.size() < elementsCount; ++id) {
+        if (deletedDistribution(randomEngine)) {
+            continue;
+        }
+
+        const float balance = balanceDistribution(randomEngine);
+        const bool bActive = activeDistribution(randomEngine);
+        users.push_back(User{id, balance, bActive});
+    }
+
+    const int32_t maximumId = users.back().Id;
+
+    std::vector<int32_t> presentIds(users.size());
+    for (std::size_t i = 0; i < users.size(); ++i) {
+        presentIds[i] = users[i].Id;
+    }
+
+    const auto isPresent = [&](const int32_t id) {
+        return std::binary_search(presentIds.begin(), presentIds.end(), id);
+    };
+
+    std::uniform_int_distribution<std::size_t> rowDistribution{0, users.size() - 1};
+    std::uniform_int_distribution<int32_t> absentDistribution{0, maximumId * 2};
+
+    const auto drawAbsentId = [&] {
+        int32_t id = absentDistribution(randomEngine);
+        while (isPresent(id)) {
+            id = absentDistribution(randomEngine);
+        }
+        return id;
+    };
+
+    const auto makeProbes = [&](const std::size_t count, const double missRatio) {
+        std::bernoulli_distribution missDistribution{missRatio};
+        std::vector<int32_t> probes(count);
+        for (int32_t& probe : probes) {
+            probe = missDistribution(randomEngine)
+                ? drawAbsentId() : presentIds[rowDistribution(randomEngine)];
+        }
+        return probes;
+    };
+
+    std::println("");
+    std::println("Building repositories...");
+
+    const VectorUserRepository scanRepository{users};
+    const IndexedUserRepository indexedRepository{std::vector<User>{users}};
+    const BloomFilteredUserRepository filteredScanRepository{scanRepository, users.size()};
+    const BloomFilteredUserRepository filteredIndexedRepository{indexedRepository, users.size()};
+
+    const BlockedBloomFilter& filter = filteredIndexedRepository.GetFilter();
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    /* Filter alone on absent ids: the cost a miss pays before it would have
+     * reached the index, and how often it is let through anyway. */
+    const std::vector<int32_t> absentProbes = makeProbes(indexLookupsCount, 1.0);
+
+    std::size_t falsePositives = 0;
+    const double filterTimeSeconds = MeasureExecutionTime(iterations, [&] {
+        falsePositives = 0;
+        for (const int32_t probe : absentProbes) {
+            falsePositives += filter.MayContain(probe) ? 1 : 0;
+        }
+        return static_cast<float>(falsePositives);
+    });
+
+    struct MissRatioResults
+    {
+        double MissRatio;
+        LookupResults Scan;
+        LookupResults FilteredScan;
+        LookupResults Indexed;
+        LookupResults FilteredIndexed;
+    };
+
+    std::vector<MissRatioResults> results;
+    for (const double missRatio : missRatios) {
+        const std::vector<int32_t> scanProbes = makeProbes(scanLookupsCount, missRatio);
+        const std::vector<int32_t> indexProbes = makeProbes(indexLookupsCount, missRatio);
+
+        results.push_back(MissRatioResults{
+            missRatio,
+            BenchmarkFindById(scanRepository, scanProbes, 1),
+            BenchmarkFindById(filteredScanRepository, scanProbes, 1),
+            BenchmarkFindById(indexedRepository, indexProbes, iterations),
+            BenchmarkFindById(filteredIndexedRepository, indexProbes, iterations),
+        });
+    }
+
+    std::println("");
+    std::println("[ Filter Results ]");
+    std::println("Filter Size                : {:.2f} MiB",
+                 static_cast<double>(filter.GetSizeBytes()) / (1024.0 * 1024.0));
+    std::println("False Positive Rate        : {:.4f} %",
+                 100.0 * static_cast<double>(falsePositives)
+                     / static_cast<double>(absentProbes.size()));
+    std::println("Negative Lookup            : {:.2f} ns",
+                 filterTimeSeconds * 1e9
+                     / static_cast<double>(iterations * absentProbes.size()));
+
+    std::println("");
+    std::println("[ FindById Results (ns per lookup) ]");
+    std::println("{:>10} | {:>14} | {:>14} | {:>12} | {:>10} | {:>11} | {:>8} | {:>8}",
+                 "Miss Ratio", "Scan", "Bloom + Scan", "Speedup",
+                 "Index", "Bloom + Idx", "Speedup", "Hits");
+
+    for (const MissRatioResults& result : results) {
+        const bool bHitsMatch = result.Scan.Hits == result.FilteredScan.Hits
+            && result.Indexed.Hits == result.FilteredIndexed.Hits;
+
+        std::println("{:>8.2f} % | {:>14.2f} | {:>14.2f} | {:>11.2f}x | {:>10.2f} | {:>11.2f} | {:>7.2f}x | {:>8}",
+                     result.MissRatio * 100.0,
+                     result.Scan.NanosecondsPerLookup,
+                     result.FilteredScan.NanosecondsPerLookup,
+                     result.Scan.NanosecondsPerLookup
+                         / result.FilteredScan.NanosecondsPerLookup,
+                     result.Indexed.NanosecondsPerLookup,
+                     result.FilteredIndexed.NanosecondsPerLookup,
+                     result.Indexed.NanosecondsPerLookup
+                         / result.FilteredIndexed.NanosecondsPerLookup,
+                     bHitsMatch ? "match" : "MISMATCH");
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/magic.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif  /* defined(__linux__) */
+
+#include "lib.hpp"
+
+#if defined(__linux__)
+
+struct User
+{
+    int32_t Id;
+    float Balance;
+    bool Active;
+};
+
+struct IUserRepository
+{
+    virtual ~IUserRepository() = default;
+    virtual void ForEach(const std::function<void(const User&)>& fn) const = 0;
+    virtual std::optional<User> FindById(int32_t id) const = 0;
+};
+
+/* Backend whose records live in a file, one fixed-size record per id, so
+ * every point read is a pread system call and, when the page is cold, a
+ * trip to the device. pread keeps no file position, so concurrent readers
+ * need no locking. */
+class FileUserRepository final : public IUserRepository
+{
+public:
+    static constexpr std::size_t ForEachChunkRecords = 4096;
+
+    FileUserRepository(const int fileDescriptor, const std::size_t count)
+        : FileDescriptor(fileDescriptor)
+        , Count(count)
+    {
+    }
+
+    ~FileUserRepository() override
+    {
+        close(FileDescriptor);
+    }
+
+    FileUserRepository(const FileUserRepository&) = delete;
+    FileUserRepository& operator=(const FileUserRepository&) = delete;
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        std::vector<User> chunk(ForEachChunkRecords);
+
+        for (std::size_t begin = 0; begin < Count; begin += ForEachChunkRecords) {
+            const std::size_t records = std::min(ForEachChunkRecords, Count - begin);
+            const ssize_t bytes = pread(
+                FileDescriptor, chunk.data(), records * sizeof(User),
+                static_cast<off_t>(begin * sizeof(User)));
+            if (bytes != static_cast<ssize_t>(records * sizeof(User))) {
+                return;
+            }
+
+            for (std::size_t i = 0; i < records; ++i) {
+                fn(chunk[i]);
+            }
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        if (id < 0 || static_cast<std::size_t>(id) >= Count) {
+            return std::nullopt;
+        }
+
+        User user;
+        const ssize_t bytes = pread(
+            FileDescriptor, &user, sizeof(User),
+            static_cast<off_t>(static_cast<std::size_t>(id) * sizeof(User)));
+        if (bytes != static_cast<ssize_t>(sizeof(User)) || user.Id != id) {
+            return std::nullopt;
+        }
+
+        return user;
+    }
+
+    /* Drops the file from the page cache, so the next reads go to the
+     * device again. */
+    void DropPageCache() const
+    {
+        fdatasync(FileDescriptor);
+        posix_fadvise(FileDescriptor, 0, 0, POSIX_FADV_DONTNEED);
+    }
+
+private:
+    int FileDescriptor;
+    std::size_t Count;
+};
+
+/* Directory for the users file: $TMPDIR when set, /tmp otherwise. Point
+ * TMPDIR at a disk-backed file system for meaningful cold rows. */
+std::string GetUsersFileDirectory()
+{
+    const char* directory = std::getenv("TMPDIR");
+    return (directory != nullptr && directory[0] != '\0') ? directory : "/tmp";
+}
+
+/* Whether the file lives on tmpfs or ramfs, where the page cache is the
+ * only copy and POSIX_FADV_DONTNEED cannot evict anything. */
+bool IsMemoryBackedFile(const int fileDescriptor)
+{
+    struct statfs fileSystem{};
+    if (fstatfs(fileDescriptor, &fileSystem) != 0) {
+        return false;
+    }
+
+    return fileSystem.f_type == TMPFS_MAGIC || fileSystem.f_type == RAMFS_MAGIC;
+}
+
+/* Writes the records to an unlinked temporary file in `directory` and
+ * returns its descriptor, or -1 on failure. */
+int CreateUsersFile(const std::span<const User> users, const std::string& directory)
+{
+    std::string path = directory + "/bench-repository-cache-XXXXXX";
+    const int fileDescriptor = mkstemp(path.data());
+    if (fileDescriptor < 0) {
+        return -1;
+    }
+    unlink(path.c_str());
+
+    const std::byte* bytes = reinterpret_cast<const std::byte*>(users.data());
+    std::size_t remaining = users.size_bytes();
+    while (remaining > 0) {
+        const ssize_t written = write(fileDescriptor, bytes, remaining);
+        if (written <= 0) {
+            close(fileDescriptor);
+            return -1;
+        }
+        bytes += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+
+    return fileDescriptor;
+}
+
+/* Read-through decorator with a CLOCK cache of hot users. The cache is
+ * split into shards by id hash, each with its own lock, so concurrent
+ * readers of different shards do not contend. A miss releases the shard
+ * lock while it reads the inner repository, so one slow read never blocks
+ * hits on the same shard. Only hits are cached: a missing id is forwarded
+ * every time. Writes are not part of the interface, so no invalidation is
+ * needed. */
+class CachingUserRepository final : public IUserRepository
+{
+public:
+    CachingUserRepository(const IUserRepository& inner,
+                          const std::size_t capacity,
+                          const std::size_t shardsCount)
+        : Inner(inner)
+        , Shards(shardsCount)
+    {
+        for (Shard& shard : Shards) {
+            shard.Slots.resize(std::max<std::size_t>(1, capacity / shardsCount));
+            shard.SlotOfId.reserve(shard.Slots.size());
+        }
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        Inner.ForEach(fn);
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        Shard& shard = Shards[ShardOf(id)];
+
+        {
+            std::lock_guard<std::mutex> lock{shard.Mutex};
+            const auto it = shard.SlotOfId.find(id);
+            if (it != shard.SlotOfId.end()) {
+                Slot& slot = shard.Slots[it->second];
+                slot.bReferenced = true;
+                Hits.fetch_add(1, std::memory_order_relaxed);
+                return slot.Value;
+            }
+        }
+
+        Misses.fetch_add(1, std::memory_order_relaxed);
+
+        const std::optional<User> user = Inner.FindById(id);
+        if (!user) {
+            return std::nullopt;
+        }
+
+        /* Another reader may have filled the slot meanwhile; only the first
+         * one evicts. Erasing the victim leaves `it` valid. */
+        std::lock_guard<std::mutex> lock{shard.Mutex};
+        const auto [it, bInserted] = shard.SlotOfId.try_emplace(id, 0u);
+        if (bInserted) {
+            const std::size_t slotIndex = shard.Evict();
+            Slot& slot = shard.Slots[slotIndex];
+            slot.Value = *user;
+            slot.bOccupied = true;
+            slot.bReferenced = false;
+            it->second = static_cast<uint32_t>(slotIndex);
+        }
+
+        return user;
+    }
+
+    double GetHitRate() const
+    {
+        const double hits = static_cast<double>(Hits.load(std::memory_order_relaxed));
+        const double misses = static_cast<double>(Misses.load(std::memory_order_relaxed));
+        return hits + misses > 0.0 ? hits / (hits + misses) : 0.0;
+    }
+
+private:
+    struct Slot
+    {
+        User Value{};
+        bool bOccupied = false;
+        bool bReferenced = false;
+    };
+
+    struct Shard
+    {
+        std::mutex Mutex;
+        std::vector<Slot> Slots;
+        std::unordered_map<int32_t, uint32_t> SlotOfId;
+        std::size_t Hand = 0;
+
+        /* Sweeps the hand past referenced slots, clearing their bit, and
+         * returns the first free or unreferenced one. */
+        std::size_t Evict()
+        {
+            while (true) {
+                Slot& slot = Slots[Hand];
+                const std::size_t candidate = Hand;
+                Hand = Hand + 1 == Slots.size() ? 0 : Hand + 1;
+
+                if (!slot.bOccupied) {
+                    return candidate;
+                }
+                if (!slot.bReferenced) {
+                    SlotOfId.erase(slot.Value.Id);
+                    return candidate;
+                }
+                slot.bReferenced = false;
+            }
+        }
+    };
+
+    std::size_t ShardOf(const int32_t id) const
+    {
+        const uint32_t hash = static_cast<uint32_t>(id) * 0x9e3779b1u;
+        return static_cast<std::size_t>(
+            (static_cast<uint64_t>(hash) * Shards.size()) >> 32);
+    }
+
+    const IUserRepository& Inner;
+    mutable std::vector<Shard> Shards;
+    mutable std::atomic<uint64_t> Hits{0};
+    mutable std::atomic<uint64_t> Misses{0};
+};
+
+/* Zipfian ids: rank k is drawn with probability proportional to
+ * 1 / (k + 1)^skew by inverting the cumulative distribution, and ranks are
+ * mapped to ids through a random permutation, so the hot users are spread
+ * over the whole file rather than packed into its first pages. */
+std::vector<int32_t> MakeZipfianIds(const std::size_t idsCount,
+                                    const std::size_t probesCount,
+                                    const double skew,
+                                    std::mt19937& randomEngine)
+{
+    std::vector<double> cumulative(idsCount);
+    double total = 0.0;
+    for (std::size_t k = 0; k < idsCount; ++k) {
+        total += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+        cumulative[k] = total;
+    }
+
+    std::vector<int32_t> idOfRank(idsCount);
+    for (std::size_t k = 0; k < idsCount; ++k) {
+        idOfRank[k] = static_cast<int32_t>(k);
+    }
+    std::shuffle(idOfRank.begin(), idOfRank.end(), randomEngine);
+
+    std::uniform_real_distribution<double> uniformDistribution{0.0, total};
+    std::vector<int32_t> ids(probesCount);
+    for (int32_t& id : ids) {
+        const std::size_t rank = static_cast<std::size_t>(
+            std::lower_bound(cumulative.begin(), cumulative.end(),
+                             uniformDistribution(randomEngine))
+            - cumulative.begin());
+        id = idOfRank[std::min(rank, idsCount - 1)];
+    }
+
+    return ids;
+}
+
+struct LookupResults
+{
+    double Checksum;
+    double NanosecondsPerLookup;
+};
+
+/* Splits the probes across `clientsCount` threads that call FindById
+ * concurrently; the time is wall-clock over all of them. */
+FORCE_NOINLINE LookupResults BenchmarkFindById(const IUserRepository& repository,
+                                               const std::span<const int32_t> probes,
+                                               const std::size_t clientsCount)
+{
+    std::vector<double> partialChecksums(clientsCount, 0.0);
+
+    const double totalTimeSeconds = MeasureExecutionTime(1, [&] {
+        std::vector<std::thread> clients;
+        clients.reserve(clientsCount);
+
+        for (std::size_t client = 0; client < clientsCount; ++client) {
+            clients.emplace_back([&, client] {
+                const std::size_t begin = probes.size() * client / clientsCount;
+                const std::size_t end = probes.size() * (client + 1) / clientsCount;
+
+                double checksum = 0.0;
+                for (std::size_t i = begin; i < end; ++i) {
+                    if (const std::optional<User> user = repository.FindById(probes[i])) {
+                        checksum += user->Balance;
+                    }
+                }
+                partialChecksums[client] = checksum;
+            });
+        }
+
+        for (std::thread& client : clients) {
+            client.join();
+        }
+
+        return 0.0f;
+    });
+
+    double checksum = 0.0;
+    for (const double partialChecksum : partialChecksums) {
+        checksum += partialChecksum;
+    }
+
+    return LookupResults{
+        checksum,
+        totalTimeSeconds * 1e9 / static_cast<double>(probes.size()),
+    };
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t lookupsCount = 1'000'000;
+    constexpr std::size_t cacheCapacity = 100'000;
+    constexpr std::size_t cacheShardsCount = 16;
+    constexpr std::array<double, 4> zipfSkews{0.0, 0.8, 0.99, 1.2};
+
+    const std::size_t clientsCount =
+        std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+    std::println("");
+    std::println("[ Repository Cache Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Lookups Count     : {}", lookupsCount);
+    std::println("Cache Capacity    : {}", cacheCapacity);
+    std::println("Cache Shards      : {}", cacheShardsCount);
+    std::println("Client Threads    : {}", clientsCount);
+
+    const std::string usersFileDirectory = GetUsersFileDirectory();
+    std::println("Users File Dir    : {}", usersFileDirectory);
+
+    std::mt19937 randomEngine{randomSeed};
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+    std::bernoulli_distribution           activeDistribution{0.6};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    std::vector<User> users;
+    users.reserve(elementsCount);
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        User user{
+            static_cast<std::int32_t>(i),
+            balanceDistribution(randomEngine),
+            activeDistribution(randomEngine)
+        };
+        users.emplace_back(std::move(user));
+    }
+
+    const int fileDescriptor = CreateUsersFile(users, usersFileDirectory);
+    if (fileDescriptor < 0) {
+        std::println("Failed to write the users file!");
+        return EXIT_FAILURE;
+    }
+
+    const bool bColdRuns = !IsMemoryBackedFile(fileDescriptor);
+    if (!bColdRuns) {
+        std::println("");
+        std::println("Warning: {} is tmpfs or ramfs, so the page cache cannot be "
+                     "dropped; skipping the cold runs. Set TMPDIR to a "
+                     "disk-backed directory to measure them.",
+                     usersFileDirectory);
+    }
+
+    const FileUserRepository fileRepository{fileDescriptor, elementsCount};
+
+    std::vector<User>().swap(users);
+
+    struct SkewResults
+    {
+        double Skew;
+        double HitRate;
+        LookupResults Backend;
+        LookupResults Cached;
+        LookupResults ColdBackend;
+        LookupResults ColdCached;
+    };
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    std::vector<SkewResults> results;
+    for (const double skew : zipfSkews) {
+        const std::vector<int32_t> probes =
+            MakeZipfianIds(elementsCount, lookupsCount, skew, randomEngine);
+
+        /* Warm: the file sits in the page cache, so the backend cost is the
+         * system call and copy. Cold: the page cache is dropped first, so
+         * the backend pays device reads until its pages come back. The
+         * cache starts empty in both and its hit rate is taken warm. */
+        SkewResults result{};
+        result.Skew = skew;
+
+        fileRepository.ForEach([](const User&) {});
+        result.Backend = BenchmarkFindById(fileRepository, probes, clientsCount);
+
+        {
+            CachingUserRepository cachingRepository{
+                fileRepository, cacheCapacity, cacheShardsCount
+            };
+            result.Cached = BenchmarkFindById(cachingRepository, probes, clientsCount);
+            result.HitRate = cachingRepository.GetHitRate();
+        }
+
+        if (bColdRuns) {
+            fileRepository.DropPageCache();
+            result.ColdBackend = BenchmarkFindById(fileRepository, probes, clientsCount);
+
+            fileRepository.DropPageCache();
+            CachingUserRepository cachingRepository{
+                fileRepository, cacheCapacity, cacheShardsCount
+            };
+            result.ColdCached = BenchmarkFindById(cachingRepository, probes, clientsCount);
+        }
+
+        results.push_back(result);
+    }
+
+    std::println("");
+    std::println("[ FindById Results (ns per lookup) ]");
+    std::println("{:>9} | {:>9} | {:>10} | {:>10} | {:>8} | {:>10} | {:>10} | {:>8} | {:>9}",
+                 "Zipf Skew", "Hit Rate", "Warm File", "Cached", "Speedup",
+                 "Cold File", "Cached", "Speedup", "Checksum");
+
+    for (const SkewResults& result : results) {
+        const bool bChecksumsMatch =
+            result.Backend.Checksum == result.Cached.Checksum
+            && (!bColdRuns
+                || (result.Backend.Checksum == result.ColdBackend.Checksum
+                    && result.Backend.Checksum == result.ColdCached.Checksum));
+
+        const double warmSpeedup = result.Backend.NanosecondsPerLookup
+            / result.Cached.NanosecondsPerLookup;
+
+        if (!bColdRuns) {
+            std::println("{:>9.2f} | {:>7.2f} % | {:>10.2f} | {:>10.2f} | {:>7.2f}x | {:>10} | {:>10} | {:>8} | {:>9}",
+                         result.Skew, result.HitRate * 100.0,
+                         result.Backend.NanosecondsPerLookup,
+                         result.Cached.NanosecondsPerLookup, warmSpeedup,
+                         "n/a", "n/a", "n/a",
+                         bChecksumsMatch ? "match" : "MISMATCH");
+            continue;
+        }
+
+        std::println("{:>9.2f} | {:>7.2f} % | {:>10.2f} | {:>10.2f} | {:>7.2f}x | {:>10.2f} | {:>10.2f} | {:>7.2f}x | {:>9}",
+                     result.Skew, result.HitRate * 100.0,
+                     result.Backend.NanosecondsPerLookup,
+                     result.Cached.NanosecondsPerLookup, warmSpeedup,
+                     result.ColdBackend.NanosecondsPerLookup,
+                     result.ColdCached.NanosecondsPerLookup,
+                     result.ColdBackend.NanosecondsPerLookup
+                         / result.ColdCached.NanosecondsPerLookup,
+                     bChecksumsMatch ? "match" : "MISMATCH");
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
+
+#else   /* defined(__linux__) */
+
+int32_t main()
+{
+    std::println("The repository cache benchmark requires Linux pread/posix_fadvise.");
+    return EXIT_FAILURE;
+}
+
+#endif  /* defined(__linux__) */
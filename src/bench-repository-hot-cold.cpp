@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+struct User
+{
+    int32_t Id;
+    float Balance;
+    bool Active;
+};
+
+/* Scan-hot fields, packed together so a scan streams 8 bytes per user. */
+struct UserHot
+{
+    float Balance;
+    bool Active;
+};
+
+/* Everything a scan never reads. Future profile fields go here, linked to
+ * the hot row by sharing its row index. */
+struct UserCold
+{
+    int32_t Id;
+};
+
+struct IUserRepository
+{
+    virtual ~IUserRepository() = default;
+    virtual void ForEach(const std::function<void(const User&)>& fn) const = 0;
+    virtual std::optional<User> FindById(int32_t id) const = 0;
+
+    /* Narrow accessor for scans that only need the hot fields. Backends that
+     * store those fields apart from the rest of the record override it. */
+    virtual void ForEachBalance(
+        const std::function<void(float balance, bool active)>& fn) const
+    {
+        ForEach([&](const User& user) {
+            fn(user.Balance, user.Active);
+        });
+    }
+};
+
+class VectorUserRepository final : public IUserRepository
+{
+public:
+    explicit VectorUserRepository(const std::vector<User>& users)
+        : Users(users)
+    {
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (const User& user : Users) {
+            fn(user);
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        for (const User& user : Users) {
+            if (user.Id == id) {
+                return user;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    std::vector<User> Users;
+};
+
+/* Splits every user into a hot and a cold row at the same index. Callers
+ * still see whole `User` records through ForEach/FindById; only scans that
+ * go through ForEachBalance get to skip the cold array. */
+class HotColdUserRepository final : public IUserRepository
+{
+public:
+    explicit HotColdUserRepository(const std::vector<User>& users)
+    {
+        Hot.reserve(users.size());
+        Cold.reserve(users.size());
+
+        for (const User& user : users) {
+            Hot.push_back(UserHot{user.Balance, user.Active});
+            Cold.push_back(UserCold{user.Id});
+        }
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (std::size_t i = 0; i < Hot.size(); ++i) {
+            fn(Assemble(i));
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        for (std::size_t i = 0; i < Cold.size(); ++i) {
+            if (Cold[i].Id == id) {
+                return Assemble(i);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void ForEachBalance(
+        const std::function<void(float balance, bool active)>& fn) const override
+    {
+        for (const UserHot& hot : Hot) {
+            fn(hot.Balance, hot.Active);
+        }
+    }
+
+    std::span<const UserHot> GetHotRows() const
+    {
+        return Hot;
+    }
+
+private:
+    User Assemble(const std::size_t row) const
+    {
+        return User{Cold[row].Id, Hot[row].Balance, Hot[row].Active};
+    }
+
+    std::vector<UserHot> Hot;
+    std::vector<UserCold> Cold;
+};
+
+[[nodiscard]] bool Qualifies(const User& user, const float minimumBalance)
+{
+    const bool bQualifies = user.Active && user.Balance >= minimumBalance;
+    return bQualifies;
+}
+
+FORCE_NOINLINE float SumActiveBalances(
+    const IUserRepository& repository, float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    repository.ForEach([&](const User& user) {
+        if (Qualifies(user, minimumBalance)){
+             accumulatedBalance += user.Balance;
+        }
+    });
+
+    return accumulatedBalance;
+}
+
+FORCE_NOINLINE float SumActiveBalancesHot(
+    const IUserRepository& repository, float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    repository.ForEachBalance([&](const float balance, const bool active) {
+        if (active && balance >= minimumBalance) {
+            accumulatedBalance += balance;
+        }
+    });
+
+    return accumulatedBalance;
+}
+
+template <class TRow>
+FORCE_NOINLINE float SumActiveBalancesRows(
+    const std::span<const TRow> rows, const float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    for (const TRow& row : rows) {
+        const float takeValue =
+            (row.Active && row.Balance >= minimumBalance) ? 1.0f : 0.0f;
+        accumulatedBalance += row.Balance * takeValue;
+    }
+
+    return accumulatedBalance;
+}
+
+struct VariantResults
+{
+    const char* Name;
+    std::size_t BytesPerUser;
+    float Checksum;
+    double AverageTimeSeconds;
+};
+
+template <class F>
+VariantResults MeasureVariant(const char* name, const std::size_t bytesPerUser,
+                              const std::size_t warmupIterations,
+                              const std::size_t iterations, F&& f)
+{
+    VariantResults results{name, bytesPerUser, 0.0f, 0.0};
+
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        results.Checksum = f();
+    }
+
+    results.AverageTimeSeconds =
+        MeasureExecutionTime(iterations, f) / static_cast<double>(iterations);
+
+    return results;
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+    constexpr std::size_t lookupsCount = 16;
+
+    std::println("");
+    std::println("[ Hot/Cold Repository Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("FindById Lookups  : {}", lookupsCount);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable table;
+    GenerateUsers(table, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(table);
+
+    /* The repositories hold the same users as the columns, as records. */
+    std::vector<User> users;
+    users.reserve(elementsCount);
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        users.push_back(User{
+            usersView.Ids[i],
+            usersView.Balances[i],
+            usersView.Active[i] != 0,
+        });
+    }
+
+    VectorUserRepository aosRepository{users};
+    HotColdUserRepository hotColdRepository{users};
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    const VariantResults variants[] = {
+        MeasureVariant("AoS Repository ForEach", sizeof(User),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalances(aosRepository, minimumBalance);
+        }),
+        MeasureVariant("AoS Repository ForEachBalance", sizeof(User),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesHot(aosRepository, minimumBalance);
+        }),
+        MeasureVariant("Hot/Cold Repository ForEach",
+                       sizeof(UserHot) + sizeof(UserCold),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalances(hotColdRepository, minimumBalance);
+        }),
+        MeasureVariant("Hot/Cold Repository ForEachBalance", sizeof(UserHot),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesHot(hotColdRepository, minimumBalance);
+        }),
+        MeasureVariant("AoS Loop", sizeof(User),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesRows(std::span<const User>{users},
+                                         minimumBalance);
+        }),
+        MeasureVariant("Hot Rows Loop", sizeof(UserHot),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesRows(hotColdRepository.GetHotRows(),
+                                         minimumBalance);
+        }),
+        MeasureVariant("SoA Loop", sizeof(float) + sizeof(uint8_t),
+                       warmupIterations, iterations, [&] {
+            return SumActiveBalancesScalar(usersView, minimumBalance);
+        }),
+    };
+
+    std::vector<int32_t> lookupIds(lookupsCount);
+    std::uniform_int_distribution<int32_t> idDistribution{
+        0, static_cast<int32_t>(elementsCount - 1)
+    };
+    for (int32_t& id : lookupIds) {
+        id = idDistribution(randomEngine);
+    }
+
+    const auto findAll = [&](const IUserRepository& repository) {
+        float found = 0.0f;
+        for (const int32_t id : lookupIds) {
+            const std::optional<User> user = repository.FindById(id);
+            found += user ? user->Balance : 0.0f;
+        }
+        return found;
+    };
+
+    float aosLookupChecksum = 0.0f;
+    float hotColdLookupChecksum = 0.0f;
+
+    const double aosLookupSeconds = MeasureExecutionTime(1, [&] {
+        aosLookupChecksum = findAll(aosRepository);
+        return aosLookupChecksum;
+    });
+    const double hotColdLookupSeconds = MeasureExecutionTime(1, [&] {
+        hotColdLookupChecksum = findAll(hotColdRepository);
+        return hotColdLookupChecksum;
+    });
+
+    std::println("");
+    std::println("[ Hot/Cold Results ]");
+    std::println("{:<36} | {:>10} | {:>20} | {:>16}",
+                 "Variant", "Bytes/User", "Checksum", "ns per Element");
+
+    for (const VariantResults& variant : variants) {
+        std::println("{:<36} | {:>10} | {:>20.2f} | {:>16.2f}",
+                     variant.Name, variant.BytesPerUser, variant.Checksum,
+                     (variant.AverageTimeSeconds * 1e9)
+                         / static_cast<double>(elementsCount));
+    }
+
+    std::println("");
+    std::println("[ FindById Results ]");
+    std::println("AoS Repository Checksum        : {:.2f}", aosLookupChecksum);
+    std::println("AoS Repository per Lookup      : {:.2f} ms",
+                 aosLookupSeconds * 1e3 / static_cast<double>(lookupsCount));
+    std::println("Hot/Cold Repository Checksum   : {:.2f}", hotColdLookupChecksum);
+    std::println("Hot/Cold Repository per Lookup : {:.2f} ms",
+                 hotColdLookupSeconds * 1e3 / static_cast<double>(lookupsCount));
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,429 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+struct User
+{
+    int32_t Id;
+    float Balance;
+    bool Active;
+};
+
+struct IUserRepository
+{
+    virtual ~IUserRepository() = default;
+    virtual void ForEach(const std::function<void(const User&)>& fn) const = 0;
+    virtual std::optional<User> FindById(int32_t id) const = 0;
+
+    /* Aggregate query pushed down into the repository, so a backend with a
+     * better physical layout than its records can answer it from there. */
+    virtual float SumActiveBalances(const float minimumBalance) const
+    {
+        float accumulatedBalance = 0.0f;
+
+        ForEach([&](const User& user) {
+            if (user.Active && user.Balance >= minimumBalance) {
+                accumulatedBalance += user.Balance;
+            }
+        });
+
+        return accumulatedBalance;
+    }
+};
+
+enum class EColumnarShadow : uint8_t
+{
+    Disabled,
+    Enabled,
+};
+
+/* With the columnar shadow enabled, the repository keeps a SoA copy of the
+ * scan-hot fields next to its records. Point reads and writes go to the
+ * records; aggregate queries go to the shadow. The shadow is built by the
+ * first aggregate query and afterwards refreshed block by block: a write
+ * only marks its block dirty, and the next aggregate recopies the dirty
+ * blocks. Like the rest of the class this is single-threaded. */
+class VectorUserRepository final : public IUserRepository
+{
+public:
+    static constexpr std::size_t ShadowBlockRows = 4096;
+
+    explicit VectorUserRepository(
+        const std::vector<User>& users,
+        const EColumnarShadow columnarShadow = EColumnarShadow::Disabled)
+        : Users(users)
+        , ColumnarShadow(columnarShadow)
+    {
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (const User& user : Users) {
+            fn(user);
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        for (const User& user : Users) {
+            if (user.Id == id) {
+                return user;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    float SumActiveBalances(const float minimumBalance) const override
+    {
+        if (ColumnarShadow == EColumnarShadow::Disabled) {
+            return IUserRepository::SumActiveBalances(minimumBalance);
+        }
+
+        RefreshShadow();
+
+        /* The shadow keeps only the scan-hot columns; the kernels never read
+         * the ids. */
+        const UsersView usersView{
+            nullptr,
+            Shadow.Column<ShadowSchema::Balance>().data(),
+            Shadow.Column<ShadowSchema::Active>().data(),
+            Shadow.Size(),
+        };
+
+#if defined(__AVX2__)
+        return SumActiveBalancesAvx2(usersView, minimumBalance);
+#else   /* defined(__AVX2__) */
+        return SumActiveBalancesScalar(usersView, minimumBalance);
+#endif  /* defined(__AVX2__) */
+    }
+
+    void Update(const std::size_t row, const User& user)
+    {
+        Users[row] = user;
+        MarkDirty(row);
+    }
+
+    void Append(const User& user)
+    {
+        Users.push_back(user);
+        MarkDirty(Users.size() - 1);
+    }
+
+    std::size_t GetRecordBytes() const
+    {
+        return Users.capacity() * sizeof(User);
+    }
+
+    std::size_t GetShadowBytes() const
+    {
+        return Shadow.Size() * (sizeof(float) + sizeof(uint8_t))
+            + DirtyBlocks.capacity() * sizeof(uint64_t);
+    }
+
+    std::size_t GetShadowRefreshedRows() const
+    {
+        return ShadowRefreshedRows;
+    }
+
+private:
+    struct ShadowSchema
+    {
+        SOA_FIELD(Balance, float);
+        SOA_FIELD(Active, uint8_t);
+
+        using Fields = SoaFieldList<Balance, Active>;
+    };
+
+    void MarkDirty(const std::size_t row)
+    {
+        if (!bShadowBuilt) {
+            return;
+        }
+
+        const std::size_t block = row / ShadowBlockRows;
+        if (block / 64 >= DirtyBlocks.size()) {
+            DirtyBlocks.resize(block / 64 + 1, 0);
+        }
+
+        DirtyBlocks[block / 64] |= uint64_t{1} << (block % 64);
+    }
+
+    void CopyRows(const std::size_t begin, const std::size_t end) const
+    {
+        const std::span<float> balances = Shadow.Column<ShadowSchema::Balance>();
+        const std::span<uint8_t> activeFlags =
+            Shadow.Column<ShadowSchema::Active>();
+
+        for (std::size_t i = begin; i < end; ++i) {
+            balances[i] = Users[i].Balance;
+            activeFlags[i] = Users[i].Active ? 1u : 0u;
+        }
+
+        ShadowRefreshedRows += end - begin;
+    }
+
+    void RefreshShadow() const
+    {
+        if (!bShadowBuilt) {
+            Shadow.Resize(Users.size());
+            CopyRows(0, Users.size());
+            DirtyBlocks.assign(
+                (Users.size() + ShadowBlockRows * 64 - 1) / (ShadowBlockRows * 64),
+                0);
+            bShadowBuilt = true;
+            return;
+        }
+
+        /* Appends have marked their blocks dirty, so growing the columns and
+         * recopying the dirty blocks also covers the new rows. */
+        Shadow.Resize(Users.size());
+
+        for (std::size_t word = 0; word < DirtyBlocks.size(); ++word) {
+            uint64_t dirtyBits = DirtyBlocks[word];
+            DirtyBlocks[word] = 0;
+
+            while (dirtyBits != 0) {
+                const std::size_t block =
+                    word * 64 + static_cast<std::size_t>(std::countr_zero(dirtyBits));
+                dirtyBits &= dirtyBits - 1;
+
+                const std::size_t begin = block * ShadowBlockRows;
+                CopyRows(begin, std::min(Users.size(), begin + ShadowBlockRows));
+            }
+        }
+    }
+
+    std::vector<User> Users;
+    EColumnarShadow ColumnarShadow;
+
+    mutable SoaTable<ShadowSchema> Shadow;
+    mutable std::vector<uint64_t> DirtyBlocks;
+    mutable std::size_t ShadowRefreshedRows = 0;
+    mutable bool bShadowBuilt = false;
+};
+
+struct UserUpdate
+{
+    std::size_t Row;
+    User Value;
+};
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+    constexpr std::size_t updatesCount = 10'000'000;
+    constexpr std::size_t updatesPerQuery[] = {0, 100, 10'000, 1'000'000};
+
+    std::println("");
+    std::println("[ Repository Columnar Shadow Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Updates Count     : {}", updatesCount);
+    std::println("Shadow Block Rows : {}", VectorUserRepository::ShadowBlockRows);
+
+    std::mt19937 randomEngine{randomSeed};
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+    std::bernoulli_distribution           activeDistribution{0.6};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    std::vector<User> users;
+    users.reserve(elementsCount);
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        User user{
+            static_cast<std::int32_t>(i),
+            balanceDistribution(randomEngine),
+            activeDistribution(randomEngine)
+        };
+        users.emplace_back(std::move(user));
+    }
+
+    std::uniform_int_distribution<std::size_t> rowDistribution{
+        0, elementsCount - 1
+    };
+
+    std::vector<UserUpdate> updates(updatesCount);
+    for (UserUpdate& update : updates) {
+        update.Row = rowDistribution(randomEngine);
+        update.Value = User{
+            static_cast<std::int32_t>(update.Row),
+            balanceDistribution(randomEngine),
+            activeDistribution(randomEngine)
+        };
+    }
+
+    VectorUserRepository plainRepository{users, EColumnarShadow::Disabled};
+    VectorUserRepository shadowRepository{users, EColumnarShadow::Enabled};
+
+    std::println("");
+    std::println("Benchmarking aggregates...");
+
+    float plainChecksum = 0.0f;
+    const double plainSeconds = MeasureExecutionTime(iterations, [&] {
+        plainChecksum = plainRepository.SumActiveBalances(minimumBalance);
+        return plainChecksum;
+    }) / static_cast<double>(iterations);
+
+    float firstShadowChecksum = 0.0f;
+    const double firstShadowSeconds = MeasureExecutionTime(1, [&] {
+        firstShadowChecksum = shadowRepository.SumActiveBalances(minimumBalance);
+        return firstShadowChecksum;
+    });
+
+    std::println("Benchmarking writes...");
+
+    /* A repository without the shadow takes the same writes, so it is both
+     * the write baseline and the plain scan the refreshed shadow must match.
+     * With the shadow built, each write also sets its block's dirty bit. */
+    VectorUserRepository updatedPlainRepository{users, EColumnarShadow::Disabled};
+
+    const auto applyUpdates = [&](VectorUserRepository& repository,
+                                  const std::size_t begin, const std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            repository.Update(updates[i].Row, updates[i].Value);
+        }
+        return static_cast<float>(end - begin);
+    };
+
+    const double plainWriteSeconds = MeasureExecutionTime(1, [&] {
+        return applyUpdates(updatedPlainRepository, 0, updatesCount);
+    });
+    const double shadowWriteSeconds = MeasureExecutionTime(1, [&] {
+        return applyUpdates(shadowRepository, 0, updatesCount);
+    });
+
+    std::println("Benchmarking refreshes...");
+
+    /* One refresh after the full update run brings the shadow back in line
+     * with the records; it has to agree with a plain scan of the same data,
+     * up to the rounding of the AVX2 kernel's lane-wise sums. */
+    float refreshedChecksum = 0.0f;
+    const double fullRefreshSeconds = MeasureExecutionTime(1, [&] {
+        refreshedChecksum = shadowRepository.SumActiveBalances(minimumBalance);
+        return refreshedChecksum;
+    });
+    const float updatedPlainChecksum =
+        updatedPlainRepository.SumActiveBalances(minimumBalance);
+    const bool bRefreshedMatches =
+        std::abs(static_cast<double>(refreshedChecksum) - updatedPlainChecksum)
+            <= 1e-3 * std::max(1.0, static_cast<double>(updatedPlainChecksum));
+
+    struct MixedResults
+    {
+        std::size_t UpdatesPerQuery;
+        double UpdateSeconds;
+        double QuerySeconds;
+        std::size_t RefreshedRows;
+    };
+
+    std::vector<MixedResults> mixedResults;
+    std::size_t nextUpdate = 0;
+
+    for (const std::size_t batch : updatesPerQuery) {
+        MixedResults results{batch, 0.0, 0.0, 0};
+
+        for (std::size_t i = 0; i < warmupIterations + iterations; ++i) {
+            if (nextUpdate + batch > updatesCount) {
+                nextUpdate = 0;
+            }
+
+            const std::size_t begin = nextUpdate;
+            const std::size_t end = begin + batch;
+            nextUpdate = end;
+
+            const std::size_t refreshedBefore =
+                shadowRepository.GetShadowRefreshedRows();
+
+            const double updateSeconds = MeasureExecutionTime(1, [&] {
+                return applyUpdates(shadowRepository, begin, end);
+            });
+            const double querySeconds = MeasureExecutionTime(1, [&] {
+                return shadowRepository.SumActiveBalances(minimumBalance);
+            });
+
+            if (i >= warmupIterations) {
+                results.UpdateSeconds += updateSeconds;
+                results.QuerySeconds += querySeconds;
+                results.RefreshedRows +=
+                    shadowRepository.GetShadowRefreshedRows() - refreshedBefore;
+            }
+        }
+
+        mixedResults.push_back(results);
+    }
+
+    std::println("");
+    std::println("[ Aggregate Results ]");
+    std::println("Plain Checksum                  : {:.2f}", plainChecksum);
+    std::println("Shadow Checksum                 : {:.2f}", firstShadowChecksum);
+    std::println("Plain Aggregate                 : {:.2f} ms", plainSeconds * 1e3);
+    std::println("Shadow First Aggregate (Build)  : {:.2f} ms",
+                 firstShadowSeconds * 1e3);
+
+    std::println("");
+    std::println("[ Memory Results ]");
+    std::println("Record Bytes                    : {:.2f} MiB",
+                 static_cast<double>(shadowRepository.GetRecordBytes()) / (1 << 20));
+    std::println("Shadow Bytes                    : {:.2f} MiB",
+                 static_cast<double>(shadowRepository.GetShadowBytes()) / (1 << 20));
+    std::println("Shadow Overhead                 : {:.2f} %",
+                 100.0 * static_cast<double>(shadowRepository.GetShadowBytes())
+                     / static_cast<double>(shadowRepository.GetRecordBytes()));
+
+    std::println("");
+    std::println("[ Write Path Results ]");
+    std::println("Write without Shadow            : {:.2f} ns",
+                 plainWriteSeconds * 1e9 / static_cast<double>(updatesCount));
+    std::println("Write with Built Shadow         : {:.2f} ns",
+                 shadowWriteSeconds * 1e9 / static_cast<double>(updatesCount));
+    std::println("Refresh after All Writes        : {:.2f} ms",
+                 fullRefreshSeconds * 1e3);
+    std::println("Plain Checksum after Writes     : {:.2f}", updatedPlainChecksum);
+    std::println("Shadow Checksum after Writes    : {:.2f}", refreshedChecksum);
+    std::println("Checksums after Writes          : {}",
+                 bRefreshedMatches ? "match" : "MISMATCH");
+
+    std::println("");
+    std::println("[ Mixed Workload Results (per Query) ]");
+    std::println("{:>17} | {:>12} | {:>16} | {:>16} | {:>14}",
+                 "Updates per Query", "Updates (ms)", "Aggregate (ms)",
+                 "Refreshed Rows", "vs Plain Scan");
+
+    for (const MixedResults& results : mixedResults) {
+        const double querySeconds =
+            results.QuerySeconds / static_cast<double>(iterations);
+        std::println("{:>17} | {:>12.3f} | {:>16.3f} | {:>16} | {:>13.2f}x",
+                     results.UpdatesPerQuery,
+                     results.UpdateSeconds * 1e3 / static_cast<double>(iterations),
+                     querySeconds * 1e3,
+                     results.RefreshedRows / iterations,
+                     plainSeconds / querySeconds);
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
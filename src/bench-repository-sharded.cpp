@@ -0,0 +1,488 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+#include "thread-pool.hpp"
+
+struct User
+{
+    int32_t Id;
+    float Balance;
+    bool Active;
+};
+
+struct IUserRepository
+{
+    virtual ~IUserRepository() = default;
+    virtual void ForEach(const std::function<void(const User&)>& fn) const = 0;
+    virtual std::optional<User> FindById(int32_t id) const = 0;
+
+    /* Aggregate query pushed down into the repository, so a backend with a
+     * better physical layout than its records can answer it from there. */
+    virtual float SumActiveBalances(const float minimumBalance) const
+    {
+        float accumulatedBalance = 0.0f;
+
+        ForEach([&](const User& user) {
+            if (user.Active && user.Balance >= minimumBalance) {
+                accumulatedBalance += user.Balance;
+            }
+        });
+
+        return accumulatedBalance;
+    }
+};
+
+class VectorUserRepository final : public IUserRepository
+{
+public:
+    explicit VectorUserRepository(const std::vector<User>& users)
+        : Users(users)
+    {
+    }
+
+    explicit VectorUserRepository(std::vector<User>&& users) noexcept
+        : Users(std::move(users))
+    {
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (const User& user : Users) {
+            fn(user);
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        for (const User& user : Users) {
+            if (user.Id == id) {
+                return user;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    float SumActiveBalances(const float minimumBalance) const override
+    {
+        float accumulatedBalance = 0.0f;
+
+        for (const User& user : Users) {
+            const float takeValue =
+                (user.Active && user.Balance >= minimumBalance) ? 1.0f : 0.0f;
+            accumulatedBalance += user.Balance * takeValue;
+        }
+
+        return accumulatedBalance;
+    }
+
+    std::size_t GetCount() const
+    {
+        return Users.size();
+    }
+
+private:
+    std::vector<User> Users;
+};
+
+enum class EShardingPolicy : uint8_t
+{
+    IdRange,
+    IdHash,
+};
+
+/* Splits users across `shardsCount` VectorUserRepository shards, either by
+ * contiguous id ranges or by id hash. FindById routes to the one shard that
+ * can hold the id; SumActiveBalances fans out to every shard on the pool
+ * and adds up the partial sums in shard order, so the result does not
+ * depend on scheduling. ForEach keeps the interface's single-threaded
+ * contract and visits the shards one after another; ForEachShard is the
+ * parallel entry point for callers that keep per-shard state. */
+class ShardedUserRepository final : public IUserRepository
+{
+public:
+    ShardedUserRepository(const std::span<const User> users,
+                          const std::size_t shardsCount,
+                          const EShardingPolicy policy,
+                          ThreadPool& pool)
+        : Policy(policy)
+        , Pool(pool)
+    {
+        int32_t maximumId = 0;
+        for (const User& user : users) {
+            maximumId = std::max(maximumId, user.Id);
+        }
+        IdsPerShard = static_cast<std::size_t>(maximumId) / shardsCount + 1;
+
+        std::vector<std::vector<User>> shardUsers(shardsCount);
+        for (std::vector<User>& shard : shardUsers) {
+            shard.reserve(users.size() / shardsCount + 1);
+        }
+        for (const User& user : users) {
+            shardUsers[ShardOf(user.Id, shardsCount)].push_back(user);
+        }
+
+        Shards.reserve(shardsCount);
+        for (std::vector<User>& shard : shardUsers) {
+            Shards.emplace_back(std::move(shard));
+        }
+    }
+
+    void ForEach(const std::function<void(const User&)>& fn) const override
+    {
+        for (const VectorUserRepository& shard : Shards) {
+            shard.ForEach(fn);
+        }
+    }
+
+    std::optional<User> FindById(const int32_t id) const override
+    {
+        if (id < 0) {
+            return std::nullopt;
+        }
+
+        return Shards[ShardOf(id, Shards.size())].FindById(id);
+    }
+
+    float SumActiveBalances(const float minimumBalance) const override
+    {
+        std::vector<float> partialBalances(Shards.size(), 0.0f);
+
+        ForEachShard([&](const std::size_t shard, const IUserRepository& repository) {
+            partialBalances[shard] = repository.SumActiveBalances(minimumBalance);
+        });
+
+        float accumulatedBalance = 0.0f;
+        for (const float partialBalance : partialBalances) {
+            accumulatedBalance += partialBalance;
+        }
+
+        return accumulatedBalance;
+    }
+
+    /* Runs `fn(shardIndex, shard)` for every shard on the pool. */
+    template <class F>
+    void ForEachShard(F&& fn) const
+    {
+        Pool.ParallelFor(Shards.size(), [&](const std::size_t shard) {
+            fn(shard, static_cast<const IUserRepository&>(Shards[shard]));
+        });
+    }
+
+    std::size_t GetShardsCount() const
+    {
+        return Shards.size();
+    }
+
+    std::size_t GetLargestShardCount() const
+    {
+        std::size_t largest = 0;
+        for (const VectorUserRepository& shard : Shards) {
+            largest = std::max(largest, shard.GetCount());
+        }
+
+        return largest;
+    }
+
+private:
+    std::size_t ShardOf(const int32_t id, const std::size_t shardsCount) const
+    {
+        if (Policy == EShardingPolicy::IdRange) {
+            return std::min(shardsCount - 1,
+                            static_cast<std::size_t>(id) / IdsPerShard);
+        }
+
+        const uint32_t hash = static_cast<uint32_t>(id) * 0x9e3779b1u;
+        return static_cast<std::size_t>(
+            (static_cast<uint64_t>(hash) * shardsCount) >> 32);
+    }
+
+    EShardingPolicy Policy;
+    ThreadPool& Pool;
+    std::size_t IdsPerShard = 1;
+    std::vector<VectorUserRepository> Shards;
+};
+
+/* The same fan-out on the same pool without the repository in the way: the
+ * SoA columns are split into per-thread ranges scanned by the SIMD kernel. */
+FORCE_NOINLINE float SumActiveBalancesParallel(
+    ThreadPool& pool, const UsersView& usersView, const float minimumBalance)
+{
+    constexpr std::size_t grainRows = 64;
+
+    const SumActiveBalancesFn sumActiveBalances = ResolveSumActiveBalances();
+    std::vector<float> partialBalances(pool.GetThreadsCount(), 0.0f);
+
+    pool.ParallelForRange(usersView.Count, grainRows,
+                          [&](const std::size_t range, const std::size_t begin,
+                              const std::size_t end) {
+        partialBalances[range] = sumActiveBalances(
+            usersView.Subview(begin, end - begin), minimumBalance);
+    });
+
+    float accumulatedBalance = 0.0f;
+    for (const float partialBalance : partialBalances) {
+        accumulatedBalance += partialBalance;
+    }
+
+    return accumulatedBalance;
+}
+
+struct VariantResults
+{
+    std::string Name;
+    float Checksum;
+    double AverageTimeSeconds;
+};
+
+template <class F>
+VariantResults MeasureVariant(std::string name,
+                              const std::size_t warmupIterations,
+                              const std::size_t iterations, F&& fn)
+{
+    float checksum = 0.0f;
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        checksum = fn();
+    }
+
+    const double totalTimeSeconds = MeasureExecutionTime(iterations, fn);
+
+    return VariantResults{
+        std::move(name), checksum,
+        totalTimeSeconds / static_cast<double>(iterations),
+    };
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+    constexpr std::size_t lookupsCount = 64;
+
+    const std::size_t threadsCount =
+        std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+    std::println("");
+    std::println("[ Sharded Repository Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Threads           : {}", threadsCount);
+    std::println("Lookups Count     : {}", lookupsCount);
+
+    std::mt19937 randomEngine{randomSeed};
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+    std::bernoulli_distribution           activeDistribution{0.6};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    std::vector<User> users;
+    users.reserve(elementsCount);
+
+    UsersTable columns;
+    columns.Resize(elementsCount);
+    const std::span<int32_t> ids = columns.Column<UserSchema::Id>();
+    const std::span<float> balances = columns.Column<UserSchema::Balance>();
+    const std::span<uint8_t> activeFlags = columns.Column<UserSchema::Active>();
+
+    for (std::size_t i = 0; i < elementsCount; ++i) {
+        User user{
+            static_cast<std::int32_t>(i),
+            balanceDistribution(randomEngine),
+            activeDistribution(randomEngine)
+        };
+
+        ids[i] = user.Id;
+        balances[i] = user.Balance;
+        activeFlags[i] = user.Active ? 1u : 0u;
+
+        users.emplace_back(std::move(user));
+    }
+
+    const UsersView usersView = MakeUsersView(columns);
+
+    std::uniform_int_distribution<int32_t> idDistribution{
+        0, static_cast<int32_t>(elementsCount - 1)
+    };
+    std::vector<int32_t> probes(lookupsCount);
+    for (int32_t& probe : probes) {
+        probe = idDistribution(randomEngine);
+    }
+
+    ThreadPool pool{threadsCount};
+
+    /* Shard counts from one up to a few per thread, so the pool always has
+     * work to balance once shards outnumber threads. */
+    std::vector<std::size_t> shardCounts;
+    for (std::size_t shards = 1; shards <= std::max<std::size_t>(threadsCount * 4, 16);
+         shards *= 2) {
+        shardCounts.push_back(shards);
+    }
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    const VectorUserRepository singleRepository{users};
+
+    std::vector<VariantResults> baselineResults;
+    baselineResults.push_back(MeasureVariant(
+        "Single Repository ForEach", warmupIterations, iterations, [&] {
+            return singleRepository.IUserRepository::SumActiveBalances(minimumBalance);
+        }));
+    baselineResults.push_back(MeasureVariant(
+        "Single Repository Pushdown", warmupIterations, iterations, [&] {
+            return singleRepository.SumActiveBalances(minimumBalance);
+        }));
+    baselineResults.push_back(MeasureVariant(
+        "SoA SIMD on Pool", warmupIterations, iterations, [&] {
+            return SumActiveBalancesParallel(pool, usersView, minimumBalance);
+        }));
+
+    double singleLookupSeconds = 0.0;
+    {
+        std::size_t hits = 0;
+        singleLookupSeconds = MeasureExecutionTime(1, [&] {
+            for (const int32_t probe : probes) {
+                hits += singleRepository.FindById(probe) ? 1 : 0;
+            }
+            return static_cast<float>(hits);
+        }) / static_cast<double>(lookupsCount);
+    }
+
+    struct ShardedResults
+    {
+        EShardingPolicy Policy;
+        std::size_t Shards;
+        std::size_t LargestShard;
+        VariantResults ForEach;
+        VariantResults Pushdown;
+        double LookupSeconds;
+        std::size_t LookupHits;
+    };
+
+    std::vector<ShardedResults> shardedResults;
+    for (const EShardingPolicy policy : {EShardingPolicy::IdRange, EShardingPolicy::IdHash}) {
+        for (const std::size_t shards : shardCounts) {
+            const ShardedUserRepository repository{users, shards, policy, pool};
+
+            ShardedResults result{
+                policy, shards, repository.GetLargestShardCount(),
+                MeasureVariant("ForEach", warmupIterations, iterations, [&] {
+                    std::vector<float> partialBalances(shards, 0.0f);
+                    repository.ForEachShard(
+                        [&](const std::size_t shard, const IUserRepository& inner) {
+                            /* Accumulated locally and stored once, so the
+                             * partials' shared cache lines are not written
+                             * per row. */
+                            float shardBalance = 0.0f;
+                            inner.ForEach([&](const User& user) {
+                                if (user.Active && user.Balance >= minimumBalance) {
+                                    shardBalance += user.Balance;
+                                }
+                            });
+                            partialBalances[shard] = shardBalance;
+                        });
+
+                    float accumulatedBalance = 0.0f;
+                    for (const float partialBalance : partialBalances) {
+                        accumulatedBalance += partialBalance;
+                    }
+                    return accumulatedBalance;
+                }),
+                MeasureVariant("Pushdown", warmupIterations, iterations, [&] {
+                    return repository.SumActiveBalances(minimumBalance);
+                }),
+                0.0, 0,
+            };
+
+            result.LookupSeconds = MeasureExecutionTime(1, [&] {
+                for (const int32_t probe : probes) {
+                    result.LookupHits += repository.FindById(probe) ? 1 : 0;
+                }
+                return static_cast<float>(result.LookupHits);
+            }) / static_cast<double>(lookupsCount);
+
+            shardedResults.push_back(std::move(result));
+        }
+    }
+
+    std::println("");
+    std::println("[ Baseline Results ]");
+    std::println("{:<28} | {:>20} | {:>14}", "Variant", "Checksum", "Time (ms)");
+    for (const VariantResults& result : baselineResults) {
+        std::println("{:<28} | {:>20.2f} | {:>14.2f}",
+                     result.Name, result.Checksum, result.AverageTimeSeconds * 1e3);
+    }
+    std::println("Single Repository FindById   : {:.2f} us",
+                 singleLookupSeconds * 1e6);
+
+    /* Shard overhead is the pushdown fan-out time against the SoA scan on
+     * the same pool: what the repository boundary costs per query once the
+     * work is spread over the same threads. */
+    const double soaTimeSeconds = baselineResults.back().AverageTimeSeconds;
+
+    std::println("");
+    std::println("[ Sharded Results ]");
+    std::println("{:<8} | {:>6} | {:>13} | {:>13} | {:>13} | {:>9} | {:>13} | {:>5}",
+                 "Policy", "Shards", "Largest Shard", "ForEach (ms)",
+                 "Pushdown (ms)", "vs SoA", "FindById (us)", "Hits");
+
+    for (const ShardedResults& result : shardedResults) {
+        std::println("{:<8} | {:>6} | {:>13} | {:>13.2f} | {:>13.2f} | {:>8.2f}x | {:>13.2f} | {:>5}",
+                     result.Policy == EShardingPolicy::IdRange ? "Range" : "Hash",
+                     result.Shards, result.LargestShard,
+                     result.ForEach.AverageTimeSeconds * 1e3,
+                     result.Pushdown.AverageTimeSeconds * 1e3,
+                     result.Pushdown.AverageTimeSeconds / soaTimeSeconds,
+                     result.LookupSeconds * 1e6, result.LookupHits);
+    }
+
+    /* Shards sum in a different order than the single repository, so the
+     * float totals may differ by reassociation; a dropped or duplicated
+     * shard is far outside that. */
+    const double baselineChecksum = baselineResults[1].Checksum;
+    const auto matchesBaseline = [&](const float checksum) {
+        return std::abs(static_cast<double>(checksum) - baselineChecksum)
+            <= 1e-3 * std::max(1.0, std::abs(baselineChecksum));
+    };
+
+    std::println("");
+    std::println("[ Sharded Checksums ]");
+    std::println("{:<8} | {:>6} | {:>20} | {:>20} | {:>8}",
+                 "Policy", "Shards", "ForEach Checksum", "Pushdown Checksum",
+                 "Baseline");
+
+    for (const ShardedResults& result : shardedResults) {
+        const bool bMatches = matchesBaseline(result.ForEach.Checksum)
+            && matchesBaseline(result.Pushdown.Checksum);
+
+        std::println("{:<8} | {:>6} | {:>20.2f} | {:>20.2f} | {:>8}",
+                     result.Policy == EShardingPolicy::IdRange ? "Range" : "Hash",
+                     result.Shards, result.ForEach.Checksum,
+                     result.Pushdown.Checksum, bMatches ? "match" : "MISMATCH");
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,549 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif  /* defined(__linux__) */
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+#if defined(__linux__)
+
+struct RankedUser
+{
+    int32_t Id;
+    float Balance;
+};
+
+enum class EQueryKind : uint32_t
+{
+    Shutdown,
+    SumActiveBalances,
+    TopBalances,
+};
+
+/* Sent to every worker. The coordinator draws each worker's injected delay
+ * and ships it with the request, so a run is reproducible from the seed and
+ * the coordinator knows which worker it is waiting for. */
+struct ScatterRequest
+{
+    EQueryKind Kind;
+    uint32_t RequestId;
+    float MinimumBalance;
+    uint32_t Limit;
+    uint32_t DelayMicroseconds;
+};
+
+/* A worker's partial result, followed by `Count` RankedUser entries for a
+ * top-K query. */
+struct GatherResult
+{
+    uint32_t RequestId;
+    uint32_t Count;
+    float Sum;
+};
+
+/* Ties broken by id, so every partitioning agrees on one top-K. A lambda
+ * rather than a function, so the heap operations inline it. */
+constexpr auto GreaterBalance = [](const RankedUser& lhs, const RankedUser& rhs) {
+    return lhs.Balance > rhs.Balance
+        || (lhs.Balance == rhs.Balance && lhs.Id < rhs.Id);
+};
+
+FORCE_NOINLINE std::size_t SelectTopBalances(
+    const UsersView& usersView, const float minimumBalance,
+    const std::size_t limit, RankedUser* RESTRICT_ALIAS top)
+{
+    std::size_t topCount = 0;
+
+    /* Once the heap is full nothing below its smallest balance can enter,
+     * so rows are first tested against that floor; after the first few
+     * thousand rows almost all of them fail it, and predictably so. */
+    float floorBalance = minimumBalance;
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        const float balanceValue = usersView.Balances[i];
+        if (balanceValue < floorBalance || !usersView.Active[i]) {
+            continue;
+        }
+
+        const RankedUser candidate{usersView.Ids[i], balanceValue};
+        if (topCount < limit) {
+            top[topCount++] = candidate;
+            std::push_heap(top, top + topCount, GreaterBalance);
+        } else if (GreaterBalance(candidate, top[0])) {
+            std::pop_heap(top, top + topCount, GreaterBalance);
+            top[topCount - 1] = candidate;
+            std::push_heap(top, top + topCount, GreaterBalance);
+        }
+
+        if (topCount == limit) {
+            floorBalance = std::max(minimumBalance, top[0].Balance);
+        }
+    }
+
+    std::sort_heap(top, top + topCount, GreaterBalance);
+
+    return topCount;
+}
+
+bool WriteFully(const int fd, const void* data, std::size_t bytes)
+{
+    const std::byte* cursor = static_cast<const std::byte*>(data);
+    while (bytes > 0) {
+        const ssize_t written = write(fd, cursor, bytes);
+        if (written <= 0) {
+            return false;
+        }
+        cursor += written;
+        bytes -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool ReadFully(const int fd, void* data, std::size_t bytes)
+{
+    std::byte* cursor = static_cast<std::byte*>(data);
+    while (bytes > 0) {
+        const ssize_t received = read(fd, cursor, bytes);
+        if (received <= 0) {
+            return false;
+        }
+        cursor += received;
+        bytes -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Worker processes
+*******************************************************************************/
+
+/* A worker copies its partition out of the inherited table into columns of
+ * its own, so it owns its memory the way a node would, then answers
+ * requests until shutdown. The injected delay is slept before the reply,
+ * standing in for the network on the way back. */
+void ServeWorker(const UsersView& usersView, const std::size_t firstRow,
+                 const std::size_t rowsCount, const int fd)
+{
+    prctl(PR_SET_TIMERSLACK, 1UL);
+
+    UsersTable partition;
+    partition.Resize(rowsCount);
+
+    const std::span<int32_t> ids = partition.Column<UserSchema::Id>();
+    const std::span<float> balances = partition.Column<UserSchema::Balance>();
+    const std::span<uint8_t> activeFlags = partition.Column<UserSchema::Active>();
+
+    std::copy_n(usersView.Ids + firstRow, rowsCount, ids.begin());
+    std::copy_n(usersView.Balances + firstRow, rowsCount, balances.begin());
+    std::copy_n(usersView.Active + firstRow, rowsCount, activeFlags.begin());
+
+    const UsersView partitionView = MakeUsersView(partition);
+
+    std::vector<RankedUser> top;
+
+    for (;;) {
+        ScatterRequest request;
+        if (!ReadFully(fd, &request, sizeof(request))
+                || request.Kind == EQueryKind::Shutdown) {
+            break;
+        }
+
+        GatherResult result{request.RequestId, 0, 0.0f};
+
+        if (request.Kind == EQueryKind::SumActiveBalances) {
+            result.Sum = SumActiveBalances(partitionView, request.MinimumBalance);
+        } else if (request.Kind == EQueryKind::TopBalances) {
+            top.resize(request.Limit);
+            result.Count = static_cast<uint32_t>(SelectTopBalances(
+                partitionView, request.MinimumBalance, request.Limit, top.data()));
+        }
+
+        if (request.DelayMicroseconds > 0) {
+            std::this_thread::sleep_for(
+                std::chrono::microseconds{request.DelayMicroseconds});
+        }
+
+        if (!WriteFully(fd, &result, sizeof(result))
+                || !WriteFully(fd, top.data(), result.Count * sizeof(RankedUser))) {
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+* Coordinator
+*******************************************************************************/
+
+struct WorkerFleet
+{
+    std::vector<int> Sockets;
+    std::vector<pid_t> Processes;
+};
+
+/* Forks one worker per row range and keeps one socket pair to each. */
+bool StartWorkers(const UsersView& usersView, const std::size_t workersCount,
+                  WorkerFleet& fleet)
+{
+    for (std::size_t worker = 0; worker < workersCount; ++worker) {
+        const std::size_t firstRow = usersView.Count * worker / workersCount;
+        const std::size_t endRow = usersView.Count * (worker + 1) / workersCount;
+
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+            return false;
+        }
+
+        const pid_t process = fork();
+        if (process < 0) {
+            close(sockets[0]);
+            close(sockets[1]);
+            return false;
+        }
+
+        if (process == 0) {
+            for (const int socket : fleet.Sockets) {
+                close(socket);
+            }
+            close(sockets[0]);
+            ServeWorker(usersView, firstRow, endRow - firstRow, sockets[1]);
+            close(sockets[1]);
+            _exit(EXIT_SUCCESS);
+        }
+
+        close(sockets[1]);
+        fleet.Sockets.push_back(sockets[0]);
+        fleet.Processes.push_back(process);
+    }
+
+    return true;
+}
+
+void StopWorkers(WorkerFleet& fleet)
+{
+    const ScatterRequest shutdownRequest{EQueryKind::Shutdown, 0, 0.0f, 0, 0};
+
+    for (const int socket : fleet.Sockets) {
+        WriteFully(socket, &shutdownRequest, sizeof(shutdownRequest));
+    }
+    for (const pid_t process : fleet.Processes) {
+        waitpid(process, nullptr, 0);
+    }
+    for (const int socket : fleet.Sockets) {
+        close(socket);
+    }
+
+    fleet.Sockets.clear();
+    fleet.Processes.clear();
+}
+
+struct MergedResult
+{
+    float Sum;
+    std::vector<RankedUser> Top;
+};
+
+/* Scatters the request with each worker's delay, then gathers replies in
+ * the order they arrive. Partial sums are added in worker order and top-K
+ * lists are merged, so the result does not depend on arrival order. */
+bool ScatterGather(WorkerFleet& fleet, ScatterRequest request,
+                   const std::span<const uint32_t> delays, MergedResult& merged,
+                   std::vector<float>& partialSums,
+                   std::vector<RankedUser>& candidates)
+{
+    const std::size_t workersCount = fleet.Sockets.size();
+
+    for (std::size_t worker = 0; worker < workersCount; ++worker) {
+        request.DelayMicroseconds = delays[worker];
+        if (!WriteFully(fleet.Sockets[worker], &request, sizeof(request))) {
+            return false;
+        }
+    }
+
+    std::vector<pollfd> pending(workersCount);
+    for (std::size_t worker = 0; worker < workersCount; ++worker) {
+        pending[worker] = pollfd{fleet.Sockets[worker], POLLIN, 0};
+    }
+
+    partialSums.assign(workersCount, 0.0f);
+    candidates.clear();
+
+    std::size_t remaining = workersCount;
+    while (remaining > 0) {
+        if (poll(pending.data(), pending.size(), -1) <= 0) {
+            return false;
+        }
+
+        for (std::size_t worker = 0; worker < workersCount; ++worker) {
+            if (pending[worker].fd < 0 || (pending[worker].revents & POLLIN) == 0) {
+                continue;
+            }
+
+            GatherResult result;
+            if (!ReadFully(fleet.Sockets[worker], &result, sizeof(result))
+                    || result.RequestId != request.RequestId) {
+                return false;
+            }
+
+            const std::size_t candidatesCount = candidates.size();
+            candidates.resize(candidatesCount + result.Count);
+            if (!ReadFully(fleet.Sockets[worker], candidates.data() + candidatesCount,
+                           result.Count * sizeof(RankedUser))) {
+                return false;
+            }
+
+            partialSums[worker] = result.Sum;
+            pending[worker].fd = -1;
+            --remaining;
+        }
+    }
+
+    merged.Sum = 0.0f;
+    for (const float partialSum : partialSums) {
+        merged.Sum += partialSum;
+    }
+
+    const std::size_t topCount = std::min<std::size_t>(request.Limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + topCount,
+                      candidates.end(), GreaterBalance);
+    merged.Top.assign(candidates.begin(), candidates.begin() + topCount);
+
+    return true;
+}
+
+/*******************************************************************************
+* Measurement
+*******************************************************************************/
+
+/* Injected one-way latency per worker and query: a fixed base, exponential
+ * jitter, and with a small probability a long stall, the way a GC pause or
+ * a retransmit looks from the coordinator. */
+struct LatencyProfile
+{
+    const char* Name;
+    double BaseMicroseconds;
+    double JitterMicroseconds;
+    double StallProbability;
+    double StallMicroseconds;
+};
+
+double Percentile(std::vector<double>& samples, const double fraction)
+{
+    const std::size_t index = static_cast<std::size_t>(
+        fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+struct ScatterResults
+{
+    std::size_t Workers;
+    const char* Profile;
+    EQueryKind Kind;
+    double MeanMicroseconds;
+    double P50Microseconds;
+    double P99Microseconds;
+    double P999Microseconds;
+    double StalledQueries;
+    bool bMatches;
+};
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 1'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr uint32_t topLimit = 16;
+    constexpr std::size_t warmupQueries = 16;
+    constexpr std::size_t queriesCount = 1'000;
+    constexpr std::array<std::size_t, 4> workerCounts{1, 2, 4, 8};
+    constexpr std::array<LatencyProfile, 3> latencyProfiles{
+        LatencyProfile{"None", 0.0, 0.0, 0.0, 0.0},
+        LatencyProfile{"LAN", 50.0, 10.0, 0.0, 0.0},
+        LatencyProfile{"LAN + Stalls", 50.0, 10.0, 0.01, 2'000.0},
+    };
+
+    std::println("");
+    std::println("[ Scatter-Gather Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Top-K Limit       : {}", topLimit);
+    std::println("Queries Count     : {}", queriesCount);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    /* Single-process reference: the top-K must match exactly, the sum only
+     * up to float reassociation across partitions. */
+    const float referenceSum = SumActiveBalances(usersView, minimumBalance);
+    std::vector<RankedUser> referenceTop(topLimit);
+    referenceTop.resize(SelectTopBalances(
+        usersView, minimumBalance, topLimit, referenceTop.data()));
+
+    std::println("");
+    std::println("Benchmarking...");
+
+    std::vector<ScatterResults> results;
+    std::vector<uint32_t> delays;
+    std::vector<double> samples;
+    std::vector<float> partialSums;
+    std::vector<RankedUser> candidates;
+    MergedResult merged{0.0f, {}};
+    uint32_t requestId = 0;
+
+    for (const std::size_t workersCount : workerCounts) {
+        WorkerFleet fleet;
+        if (!StartWorkers(usersView, workersCount, fleet)) {
+            std::println("Failed to start the worker processes!");
+            StopWorkers(fleet);
+            return EXIT_FAILURE;
+        }
+
+        for (const LatencyProfile& profile : latencyProfiles) {
+            std::exponential_distribution<double> jitterDistribution{
+                profile.JitterMicroseconds > 0.0 ? 1.0 / profile.JitterMicroseconds : 1.0
+            };
+            std::bernoulli_distribution stallDistribution{profile.StallProbability};
+
+            for (const EQueryKind kind : {EQueryKind::SumActiveBalances, EQueryKind::TopBalances}) {
+                samples.clear();
+                std::size_t stalledQueries = 0;
+                bool bMatches = true;
+
+                for (std::size_t query = 0; query < warmupQueries + queriesCount; ++query) {
+                    delays.assign(workersCount, 0);
+                    bool bStalled = false;
+                    for (uint32_t& delay : delays) {
+                        double microseconds = profile.BaseMicroseconds;
+                        if (profile.JitterMicroseconds > 0.0) {
+                            microseconds += jitterDistribution(randomEngine);
+                        }
+                        if (stallDistribution(randomEngine)) {
+                            microseconds += profile.StallMicroseconds;
+                            bStalled = true;
+                        }
+                        delay = static_cast<uint32_t>(microseconds);
+                    }
+
+                    const ScatterRequest request{
+                        kind, ++requestId, minimumBalance, topLimit, 0,
+                    };
+
+                    const std::chrono::time_point<std::chrono::steady_clock> start{
+                        std::chrono::steady_clock::now()
+                    };
+
+                    if (!ScatterGather(fleet, request, delays, merged,
+                                       partialSums, candidates)) {
+                        std::println("Lost a worker during scatter-gather!");
+                        StopWorkers(fleet);
+                        return EXIT_FAILURE;
+                    }
+
+                    const std::chrono::time_point<std::chrono::steady_clock> end{
+                        std::chrono::steady_clock::now()
+                    };
+
+                    if (query < warmupQueries) {
+                        continue;
+                    }
+
+                    samples.push_back(
+                        std::chrono::duration<double, std::micro>(end - start).count());
+                    stalledQueries += bStalled ? 1 : 0;
+
+                    if (kind == EQueryKind::SumActiveBalances) {
+                        bMatches = bMatches
+                            && std::abs(merged.Sum - referenceSum)
+                                <= 1e-5f * std::abs(referenceSum);
+                    } else {
+                        bMatches = bMatches
+                            && merged.Top.size() == referenceTop.size()
+                            && std::equal(merged.Top.begin(), merged.Top.end(),
+                                          referenceTop.begin(),
+                                          [](const RankedUser& lhs, const RankedUser& rhs) {
+                                              return lhs.Id == rhs.Id
+                                                  && lhs.Balance == rhs.Balance;
+                                          });
+                    }
+                }
+
+                double totalMicroseconds = 0.0;
+                for (const double sample : samples) {
+                    totalMicroseconds += sample;
+                }
+
+                ScatterResults result{
+                    workersCount, profile.Name, kind,
+                    totalMicroseconds / static_cast<double>(samples.size()),
+                    0.0, 0.0, 0.0,
+                    static_cast<double>(stalledQueries) / static_cast<double>(samples.size()),
+                    bMatches,
+                };
+                result.P50Microseconds = Percentile(samples, 0.50);
+                result.P99Microseconds = Percentile(samples, 0.99);
+                result.P999Microseconds = Percentile(samples, 0.999);
+
+                results.push_back(result);
+            }
+        }
+
+        StopWorkers(fleet);
+    }
+
+    /* A query is as slow as its slowest worker, so the share of queries that
+     * hit a stall grows as 1 - (1 - p)^workers and pulls the tail with it. */
+    std::println("");
+    std::println("[ Scatter-Gather Results (us per query) ]");
+    std::println("{:>7} | {:<12} | {:<5} | {:>10} | {:>10} | {:>10} | {:>10} | {:>9} | {:>8}",
+                 "Workers", "Latency", "Query", "Mean", "P50", "P99", "P999",
+                 "Stalled", "Result");
+
+    for (const ScatterResults& result : results) {
+        std::println("{:>7} | {:<12} | {:<5} | {:>10.2f} | {:>10.2f} | {:>10.2f} | {:>10.2f} | {:>7.2f} % | {:>8}",
+                     result.Workers, result.Profile,
+                     result.Kind == EQueryKind::SumActiveBalances ? "Sum" : "Top-K",
+                     result.MeanMicroseconds, result.P50Microseconds,
+                     result.P99Microseconds, result.P999Microseconds,
+                     result.StalledQueries * 100.0,
+                     result.bMatches ? "match" : "MISMATCH");
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
+
+#else   /* defined(__linux__) */
+
+int32_t main()
+{
+    std::println("The scatter-gather benchmark requires Linux processes and sockets.");
+    return EXIT_FAILURE;
+}
+
+#endif  /* defined(__linux__) */
@@ -0,0 +1,744 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <print>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <immintrin.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif  /* defined(__linux__) */
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+#if defined(__linux__)
+
+struct RankedUser
+{
+    int32_t Id;
+    float Balance;
+};
+
+enum class EQueryKind : uint32_t
+{
+    Shutdown,
+    TopBalances,
+    Selection,
+};
+
+struct QueryRequest
+{
+    EQueryKind Kind;
+    uint32_t RequestId;
+    float MinimumBalance;
+    uint32_t Limit;
+    uint32_t FirstRow;
+    uint32_t RowsCount;
+};
+
+struct QueryResult
+{
+    uint64_t Offset;
+    uint64_t Length;
+    uint32_t RequestId;
+    uint32_t Count;
+};
+
+FORCE_NOINLINE std::size_t SelectActiveBalances(
+    const UsersView& usersView, const float minimumBalance,
+    uint32_t* RESTRICT_ALIAS selection)
+{
+    std::size_t selectedCount = 0;
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        selection[selectedCount] = static_cast<uint32_t>(i);
+        selectedCount +=
+            (usersView.Active[i] && usersView.Balances[i] >= minimumBalance)
+                ? 1u : 0u;
+    }
+
+    return selectedCount;
+}
+
+FORCE_NOINLINE std::size_t SelectTopBalances(
+    const UsersView& usersView, const float minimumBalance,
+    const std::size_t limit, RankedUser* RESTRICT_ALIAS top)
+{
+    const auto greaterBalance = [](const RankedUser& lhs, const RankedUser& rhs) {
+        return lhs.Balance > rhs.Balance;
+    };
+
+    std::size_t topCount = 0;
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        const float balanceValue = usersView.Balances[i];
+        if (!usersView.Active[i] || balanceValue < minimumBalance) {
+            continue;
+        }
+
+        if (topCount < limit) {
+            top[topCount++] = RankedUser{usersView.Ids[i], balanceValue};
+            std::push_heap(top, top + topCount, greaterBalance);
+        } else if (balanceValue > top[0].Balance) {
+            std::pop_heap(top, top + topCount, greaterBalance);
+            top[topCount - 1] = RankedUser{usersView.Ids[i], balanceValue};
+            std::push_heap(top, top + topCount, greaterBalance);
+        }
+    }
+
+    std::sort_heap(top, top + topCount, greaterBalance);
+
+    return topCount;
+}
+
+/* Runs a query and writes its result straight into `payload`, which is either
+ * a block of the shared arena or the private send buffer of the socket path. */
+QueryResult RunQuery(const UsersView& usersView, const QueryRequest& request,
+                     std::byte* payload)
+{
+    QueryResult result{0, 0, request.RequestId, 0};
+
+    const UsersView rows = usersView.Subview(request.FirstRow, request.RowsCount);
+
+    if (request.Kind == EQueryKind::TopBalances) {
+        const std::size_t count = SelectTopBalances(
+            rows, request.MinimumBalance, request.Limit,
+            reinterpret_cast<RankedUser*>(payload));
+        result.Length = count * sizeof(RankedUser);
+        result.Count = static_cast<uint32_t>(count);
+    } else if (request.Kind == EQueryKind::Selection) {
+        const std::size_t count = SelectActiveBalances(
+            rows, request.MinimumBalance,
+            reinterpret_cast<uint32_t*>(payload));
+        result.Length = count * sizeof(uint32_t);
+        result.Count = static_cast<uint32_t>(count);
+    }
+
+    return result;
+}
+
+double ConsumeResult(const EQueryKind kind, const std::byte* payload,
+                     const uint32_t count)
+{
+    double checksum = 0.0;
+
+    if (kind == EQueryKind::TopBalances) {
+        const RankedUser* top = reinterpret_cast<const RankedUser*>(payload);
+        for (uint32_t i = 0; i < count; ++i) {
+            checksum += static_cast<double>(top[i].Balance);
+        }
+    } else {
+        const uint32_t* selection = reinterpret_cast<const uint32_t*>(payload);
+        uint64_t indexSum = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            indexSum += selection[i];
+        }
+        checksum = static_cast<double>(indexSum);
+    }
+
+    return checksum;
+}
+
+/*******************************************************************************
+* Futex-backed shared-memory ring
+*******************************************************************************/
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+/* Shared (non-private) futex ops, since the waiters live in other processes. */
+void FutexWait(std::atomic<uint32_t>& word, const uint32_t expected)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT,
+            expected, nullptr, nullptr, 0);
+}
+
+void FutexWake(std::atomic<uint32_t>& word, const int32_t waiters)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE,
+            waiters, nullptr, nullptr, 0);
+}
+
+/* Bounded multi-producer / single-consumer ring of descriptors with per-slot
+ * sequence numbers. With one producer the head CAS never contends, so the
+ * same type serves the SPSC case. Payloads are never copied through the ring:
+ * a producer claims a position, writes the payload into the arena block that
+ * belongs to that position, then publishes a descriptor carrying its offset.
+ * The block stays owned by the consumer until it releases the position. */
+template <class T, std::size_t Capacity>
+struct ShmRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+    static constexpr std::size_t SpinCount = 256;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> Sequence;
+        T Value;
+    };
+
+    alignas(64) std::atomic<uint64_t> Head{0};
+    alignas(64) std::atomic<uint64_t> Tail{0};
+    alignas(64) std::atomic<uint32_t> Published{0};
+    std::atomic<uint32_t> ConsumerWaiting{0};
+    alignas(64) std::atomic<uint32_t> Released{0};
+    std::atomic<uint32_t> ProducersWaiting{0};
+    Slot Slots[Capacity];
+
+    ShmRing()
+    {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            Slots[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    static constexpr std::size_t SlotIndex(const uint64_t position)
+    {
+        return static_cast<std::size_t>(position & (Capacity - 1));
+    }
+
+    uint64_t Claim()
+    {
+        uint64_t position = Head.load(std::memory_order_relaxed);
+        std::size_t spins = 0;
+
+        for (;;) {
+            const uint32_t released = Released.load();
+            const uint64_t sequence =
+                Slots[SlotIndex(position)].Sequence.load(std::memory_order_acquire);
+            const int64_t distance =
+                static_cast<int64_t>(sequence - position);
+
+            if (distance == 0) {
+                if (Head.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed)) {
+                    return position;
+                }
+            } else if (distance < 0) {
+                if (++spins < SpinCount) {
+                    _mm_pause();
+                } else {
+                    ProducersWaiting.fetch_add(1);
+                    FutexWait(Released, released);
+                    ProducersWaiting.fetch_sub(1);
+                }
+                position = Head.load(std::memory_order_relaxed);
+            } else {
+                position = Head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void Publish(const uint64_t position, const T& value)
+    {
+        Slot& slot = Slots[SlotIndex(position)];
+        slot.Value = value;
+        slot.Sequence.store(position + 1, std::memory_order_release);
+
+        Published.fetch_add(1);
+        if (ConsumerWaiting.load() != 0) {
+            FutexWake(Published, 1);
+        }
+    }
+
+    uint64_t Acquire(T& value)
+    {
+        const uint64_t position = Tail.load(std::memory_order_relaxed);
+        Slot& slot = Slots[SlotIndex(position)];
+        std::size_t spins = 0;
+
+        for (;;) {
+            const uint32_t published = Published.load();
+            if (slot.Sequence.load(std::memory_order_acquire) == position + 1) {
+                break;
+            }
+
+            if (++spins < SpinCount) {
+                _mm_pause();
+            } else {
+                ConsumerWaiting.store(1);
+                FutexWait(Published, published);
+                ConsumerWaiting.store(0);
+            }
+        }
+
+        value = slot.Value;
+        Tail.store(position + 1, std::memory_order_relaxed);
+
+        return position;
+    }
+
+    void Release(const uint64_t position)
+    {
+        Slots[SlotIndex(position)].Sequence.store(
+            position + Capacity, std::memory_order_release);
+
+        Released.fetch_add(1);
+        if (ProducersWaiting.load() != 0) {
+            FutexWake(Released, INT_MAX);
+        }
+    }
+};
+
+constexpr std::size_t RequestSlots = 16;
+constexpr std::size_t ResultSlots = 8;
+
+struct SharedRegion
+{
+    ShmRing<QueryRequest, RequestSlots> Requests;
+    ShmRing<QueryResult, ResultSlots> Results;
+};
+
+/* The region header is followed by `ResultSlots` arena blocks; result ring
+ * position p always writes into block (p % ResultSlots). Offsets are relative
+ * to the mapping, so they stay valid in processes mapping it elsewhere. */
+struct SharedTransport
+{
+    std::byte* Base;
+    std::size_t MappedBytes;
+    std::size_t ArenaOffset;
+    std::size_t BlockBytes;
+
+    SharedRegion& Region() const
+    {
+        return *reinterpret_cast<SharedRegion*>(Base);
+    }
+
+    uint64_t BlockOffset(const uint64_t position) const
+    {
+        return ArenaOffset +
+            (position & (ResultSlots - 1)) * static_cast<uint64_t>(BlockBytes);
+    }
+};
+
+bool CreateSharedTransport(const std::size_t blockBytes,
+                           SharedTransport& transport)
+{
+    constexpr std::size_t pageBytes = 4096;
+    const std::size_t arenaOffset =
+        (sizeof(SharedRegion) + pageBytes - 1) / pageBytes * pageBytes;
+    const std::size_t mappedBytes = arenaOffset + ResultSlots * blockBytes;
+
+    /* An anonymous shared mapping inherited across fork() stands in for a
+     * memfd/shm_open segment handed to an unrelated client process. */
+    void* mapping = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    transport.Base = static_cast<std::byte*>(mapping);
+    transport.MappedBytes = mappedBytes;
+    transport.ArenaOffset = arenaOffset;
+    transport.BlockBytes = blockBytes;
+    new (transport.Base) SharedRegion{};
+
+    return true;
+}
+
+void DestroySharedTransport(SharedTransport& transport)
+{
+    transport.Region().~SharedRegion();
+    munmap(transport.Base, transport.MappedBytes);
+}
+
+/*******************************************************************************
+* Server processes
+*******************************************************************************/
+
+bool WriteFully(const int fd, const void* data, std::size_t bytes)
+{
+    const std::byte* cursor = static_cast<const std::byte*>(data);
+    while (bytes > 0) {
+        const ssize_t written = write(fd, cursor, bytes);
+        if (written <= 0) {
+            return false;
+        }
+        cursor += written;
+        bytes -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool ReadFully(const int fd, void* data, std::size_t bytes)
+{
+    std::byte* cursor = static_cast<std::byte*>(data);
+    while (bytes > 0) {
+        const ssize_t received = read(fd, cursor, bytes);
+        if (received <= 0) {
+            return false;
+        }
+        cursor += received;
+        bytes -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+void ServeShared(const UsersView& usersView, const SharedTransport& transport)
+{
+    SharedRegion& region = transport.Region();
+
+    for (;;) {
+        QueryRequest request;
+        const uint64_t requestPosition = region.Requests.Acquire(request);
+        region.Requests.Release(requestPosition);
+
+        if (request.Kind == EQueryKind::Shutdown) {
+            break;
+        }
+
+        const uint64_t resultPosition = region.Results.Claim();
+        const uint64_t offset = transport.BlockOffset(resultPosition);
+
+        QueryResult result =
+            RunQuery(usersView, request, transport.Base + offset);
+        result.Offset = offset;
+
+        region.Results.Publish(resultPosition, result);
+    }
+}
+
+void ServeSocket(const UsersView& usersView, const int fd,
+                 const std::size_t blockBytes)
+{
+    std::vector<std::byte> sendBuffer(blockBytes);
+
+    for (;;) {
+        QueryRequest request;
+        if (!ReadFully(fd, &request, sizeof(request))
+                || request.Kind == EQueryKind::Shutdown) {
+            break;
+        }
+
+        const QueryResult result =
+            RunQuery(usersView, request, sendBuffer.data());
+
+        if (!WriteFully(fd, &result, sizeof(result))
+                || !WriteFully(fd, sendBuffer.data(), result.Length)) {
+            break;
+        }
+    }
+}
+
+/* Every producer publishes `resultsPerProducer` results for its own copy of
+ * `request`, shifted to its own row window, so the consumer sees genuine MPSC
+ * contention on the head of the result ring. */
+void ServeSharedProducers(const UsersView& usersView,
+                          const SharedTransport& transport,
+                          const std::size_t producersCount,
+                          const std::size_t resultsPerProducer,
+                          const QueryRequest& request)
+{
+    SharedRegion& region = transport.Region();
+
+    std::vector<std::thread> producers;
+    producers.reserve(producersCount);
+
+    for (std::size_t p = 0; p < producersCount; ++p) {
+        producers.emplace_back([&, p] {
+            QueryRequest producerRequest = request;
+            producerRequest.RequestId = static_cast<uint32_t>(p);
+            producerRequest.FirstRow =
+                request.FirstRow + static_cast<uint32_t>(p) * request.RowsCount;
+
+            for (std::size_t i = 0; i < resultsPerProducer; ++i) {
+                const uint64_t position = region.Results.Claim();
+                const uint64_t offset = transport.BlockOffset(position);
+
+                QueryResult result = RunQuery(
+                    usersView, producerRequest, transport.Base + offset);
+                result.Offset = offset;
+
+                region.Results.Publish(position, result);
+            }
+        });
+    }
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+}
+
+/*******************************************************************************
+* Client side
+*******************************************************************************/
+
+struct LatencyResults
+{
+    double Checksum;
+    double TotalTimeSeconds;
+    double PayloadBytes;
+    std::vector<double> RoundTripMicroseconds;
+};
+
+double Percentile(std::vector<double>& samples, const double fraction)
+{
+    const std::size_t index = static_cast<std::size_t>(
+        fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+template <class F>
+LatencyResults MeasureRoundTrips(const std::size_t warmupRoundTrips,
+                                 const std::size_t roundTrips, F&& roundTrip)
+{
+    LatencyResults results{0.0, 0.0, 0.0, {}};
+    results.RoundTripMicroseconds.reserve(roundTrips);
+
+    uint64_t payloadBytes = 0;
+    for (std::size_t i = 0; i < warmupRoundTrips; ++i) {
+        results.Checksum = roundTrip(payloadBytes);
+    }
+
+    payloadBytes = 0;
+    for (std::size_t i = 0; i < roundTrips; ++i) {
+        const std::chrono::time_point<std::chrono::steady_clock> start{
+            std::chrono::steady_clock::now()
+        };
+
+        results.Checksum = roundTrip(payloadBytes);
+
+        const std::chrono::time_point<std::chrono::steady_clock> end{
+            std::chrono::steady_clock::now()
+        };
+
+        const double microseconds =
+            std::chrono::duration<double, std::micro>(end - start).count();
+        results.RoundTripMicroseconds.push_back(microseconds);
+        results.TotalTimeSeconds += microseconds * 1e-6;
+    }
+
+    results.PayloadBytes =
+        static_cast<double>(payloadBytes) / static_cast<double>(roundTrips);
+
+    return results;
+}
+
+void PrintLatencyResults(const char* title, LatencyResults& results)
+{
+    const std::size_t roundTrips = results.RoundTripMicroseconds.size();
+    const double averageMicroseconds =
+        (results.TotalTimeSeconds * 1e6) / static_cast<double>(roundTrips);
+    const double p50 = Percentile(results.RoundTripMicroseconds, 0.50);
+    const double p99 = Percentile(results.RoundTripMicroseconds, 0.99);
+
+    std::println("");
+    std::println("[ {} ]", title);
+    std::println("Checksum                   : {:.8f}", results.Checksum);
+    std::println("Payload Bytes per Result   : {:.0f}", results.PayloadBytes);
+    std::println("Total Time                 : {:.2f} s", results.TotalTimeSeconds);
+    std::println("Average Round Trip         : {:.2f} us", averageMicroseconds);
+    std::println("P50 Round Trip             : {:.2f} us", p50);
+    std::println("P99 Round Trip             : {:.2f} us", p99);
+    std::println("Round Trips per Second     : {:.2f} K",
+                 static_cast<double>(roundTrips) / results.TotalTimeSeconds / 1e3);
+    std::println("Payload Throughput         : {:.2f} GB/s",
+                 results.PayloadBytes * static_cast<double>(roundTrips)
+                     / results.TotalTimeSeconds / 1e9);
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 1'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr uint32_t topLimit = 16;
+    constexpr uint32_t windowRowsCount = 4'096;
+    constexpr std::size_t warmupRoundTrips = 8;
+    constexpr std::size_t smallRoundTrips = 2'000;
+    constexpr std::size_t largeRoundTrips = 64;
+    constexpr std::size_t producersCount = 4;
+    constexpr std::size_t resultsPerProducer = 20'000;
+
+    /* Large enough for a selection vector that keeps every row. */
+    constexpr std::size_t blockBytes = elementsCount * sizeof(uint32_t);
+
+    std::println("");
+    std::println("[ Shared-Memory Ring Transport Benchmark ]");
+    std::println("Elements Count       : {}", elementsCount);
+    std::println("Minimum Balance      : {:.2f}", minimumBalance);
+    std::println("Random Seed          : {}", randomSeed);
+    std::println("Top-K Limit          : {}", topLimit);
+    std::println("Top-K Window Rows    : {}", windowRowsCount);
+    std::println("Small Round Trips    : {}", smallRoundTrips);
+    std::println("Large Round Trips    : {}", largeRoundTrips);
+    std::println("MPSC Producers       : {}", producersCount);
+    std::println("Results per Producer : {}", resultsPerProducer);
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    /* Small results are top-K lists over a page-sized window of rows, so the
+     * transport rather than the scan dominates; large results are selection
+     * vectors over the whole table. */
+    const QueryRequest smallRequest{
+        EQueryKind::TopBalances, 0, minimumBalance, topLimit,
+        0, windowRowsCount,
+    };
+    const QueryRequest largeRequest{
+        EQueryKind::Selection, 0, minimumBalance, 0,
+        0, static_cast<uint32_t>(elementsCount),
+    };
+    const QueryRequest shutdownRequest{
+        EQueryKind::Shutdown, 0, 0.0f, 0, 0, 0,
+    };
+
+    std::println("");
+    std::println("Benchmarking Unix socket transport...");
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+        std::println("Failed to create the socket pair!");
+        return EXIT_FAILURE;
+    }
+
+    const pid_t socketServer = fork();
+    if (socketServer == 0) {
+        close(sockets[0]);
+        ServeSocket(usersView, sockets[1], blockBytes);
+        close(sockets[1]);
+        _exit(EXIT_SUCCESS);
+    }
+    close(sockets[1]);
+
+    std::vector<std::byte> receiveBuffer(blockBytes);
+
+    const auto socketRoundTrip = [&](const QueryRequest& request) {
+        return [&](uint64_t& payloadBytes) {
+            QueryResult result;
+            WriteFully(sockets[0], &request, sizeof(request));
+            ReadFully(sockets[0], &result, sizeof(result));
+            ReadFully(sockets[0], receiveBuffer.data(), result.Length);
+            payloadBytes += result.Length;
+            return ConsumeResult(request.Kind, receiveBuffer.data(), result.Count);
+        };
+    };
+
+    LatencyResults socketSmall = MeasureRoundTrips(
+        warmupRoundTrips, smallRoundTrips, socketRoundTrip(smallRequest));
+    LatencyResults socketLarge = MeasureRoundTrips(
+        warmupRoundTrips, largeRoundTrips, socketRoundTrip(largeRequest));
+
+    WriteFully(sockets[0], &shutdownRequest, sizeof(shutdownRequest));
+    waitpid(socketServer, nullptr, 0);
+    close(sockets[0]);
+
+    std::println("");
+    std::println("Benchmarking shared-memory ring transport...");
+
+    SharedTransport transport;
+    if (!CreateSharedTransport(blockBytes, transport)) {
+        std::println("Failed to map the shared-memory transport!");
+        return EXIT_FAILURE;
+    }
+
+    const pid_t sharedServer = fork();
+    if (sharedServer == 0) {
+        ServeShared(usersView, transport);
+        _exit(EXIT_SUCCESS);
+    }
+
+    SharedRegion& region = transport.Region();
+
+    const auto sharedRoundTrip = [&](const QueryRequest& request) {
+        return [&](uint64_t& payloadBytes) {
+            region.Requests.Publish(region.Requests.Claim(), request);
+
+            QueryResult result;
+            const uint64_t position = region.Results.Acquire(result);
+            const double checksum = ConsumeResult(
+                request.Kind, transport.Base + result.Offset, result.Count);
+            region.Results.Release(position);
+
+            payloadBytes += result.Length;
+            return checksum;
+        };
+    };
+
+    LatencyResults sharedSmall = MeasureRoundTrips(
+        warmupRoundTrips, smallRoundTrips, sharedRoundTrip(smallRequest));
+    LatencyResults sharedLarge = MeasureRoundTrips(
+        warmupRoundTrips, largeRoundTrips, sharedRoundTrip(largeRequest));
+
+    region.Requests.Publish(region.Requests.Claim(), shutdownRequest);
+    waitpid(sharedServer, nullptr, 0);
+
+    std::println("");
+    std::println("Benchmarking MPSC shared-memory ring...");
+
+    const pid_t producersServer = fork();
+    if (producersServer == 0) {
+        ServeSharedProducers(usersView, transport, producersCount,
+                             resultsPerProducer, smallRequest);
+        _exit(EXIT_SUCCESS);
+    }
+
+    const std::size_t mpscResultsCount = producersCount * resultsPerProducer;
+    double mpscChecksum = 0.0;
+
+    const double mpscTimeSeconds = MeasureExecutionTime(1, [&] {
+        for (std::size_t i = 0; i < mpscResultsCount; ++i) {
+            QueryResult result;
+            const uint64_t position = region.Results.Acquire(result);
+            mpscChecksum += ConsumeResult(
+                EQueryKind::TopBalances, transport.Base + result.Offset,
+                result.Count);
+            region.Results.Release(position);
+        }
+        return 0.0f;
+    });
+
+    waitpid(producersServer, nullptr, 0);
+    DestroySharedTransport(transport);
+
+    PrintLatencyResults("Unix Socket Results: Top-K", socketSmall);
+    PrintLatencyResults("Shared-Memory Ring Results: Top-K", sharedSmall);
+    PrintLatencyResults("Unix Socket Results: Selection Vector", socketLarge);
+    PrintLatencyResults("Shared-Memory Ring Results: Selection Vector", sharedLarge);
+
+    std::println("");
+    std::println("[ MPSC Shared-Memory Ring Results ]");
+    std::println("Checksum                   : {:.8f}", mpscChecksum);
+    std::println("Total Time                 : {:.2f} s", mpscTimeSeconds);
+    std::println("Results per Second         : {:.2f} K",
+                 static_cast<double>(mpscResultsCount) / mpscTimeSeconds / 1e3);
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
+
+#else   /* defined(__linux__) */
+
+int32_t main()
+{
+    std::println("The shared-memory ring benchmark requires Linux futexes.");
+    return EXIT_FAILURE;
+}
+
+#endif  /* defined(__linux__) */
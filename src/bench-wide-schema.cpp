@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <print>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dod-users.hpp"
+#include "lib.hpp"
+
+/* A production-width user record: the three fields of `User` followed by
+ * `PayloadFields` cold profile fields the query never reads. */
+template <std::size_t PayloadFields>
+struct WideUser
+{
+    int32_t Id;
+    float Balance;
+    bool Active;
+    float Payload[PayloadFields];
+};
+
+template <class TUser>
+struct IUserRepository
+{
+    virtual ~IUserRepository() = default;
+    virtual void ForEach(const std::function<void(const TUser&)>& fn) const = 0;
+};
+
+template <class TUser>
+class VectorUserRepository final : public IUserRepository<TUser>
+{
+public:
+    explicit VectorUserRepository(std::vector<TUser>&& users) noexcept
+        : Users(std::move(users))
+    {
+    }
+
+    void ForEach(const std::function<void(const TUser&)>& fn) const override
+    {
+        for (const TUser& user : Users) {
+            fn(user);
+        }
+    }
+
+    const std::vector<TUser>& GetUsers() const
+    {
+        return Users;
+    }
+
+private:
+    std::vector<TUser> Users;
+};
+
+template <class TUser>
+FORCE_NOINLINE float SumActiveBalances(
+    const IUserRepository<TUser>& repository, const float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    repository.ForEach([&](const TUser& user) {
+        if (user.Active && user.Balance >= minimumBalance) {
+            accumulatedBalance += user.Balance;
+        }
+    });
+
+    return accumulatedBalance;
+}
+
+/* Same AoS records without the repository: isolates the layout cost. */
+template <class TUser>
+FORCE_NOINLINE float SumActiveBalancesAos(
+    const std::vector<TUser>& users, const float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+
+    for (const TUser& user : users) {
+        const float takeValue =
+            (user.Active && user.Balance >= minimumBalance) ? 1.0f : 0.0f;
+        accumulatedBalance += user.Balance * takeValue;
+    }
+
+    return accumulatedBalance;
+}
+
+struct WidthResults
+{
+    std::size_t RecordBytes;
+    double RepositoryChecksum;
+    double RepositorySeconds;
+    double AosSeconds;
+    double ScalarSeconds;
+    double Avx2Checksum;
+    double Avx2Seconds;
+};
+
+template <class F>
+double MeasureAverageTime(const std::size_t warmupIterations,
+                          const std::size_t iterations, float& checksum, F&& f)
+{
+    for (std::size_t i = 0; i < warmupIterations; ++i) {
+        checksum = f();
+    }
+
+    return MeasureExecutionTime(iterations, f) / static_cast<double>(iterations);
+}
+
+template <std::size_t PayloadFields>
+WidthResults BenchmarkWidth(const UsersView& usersView,
+                            const float minimumBalance,
+                            const std::size_t warmupIterations,
+                            const std::size_t iterations)
+{
+    using TUser = WideUser<PayloadFields>;
+
+    std::println("Generating {}-byte records...", sizeof(TUser));
+
+    std::vector<TUser> users(usersView.Count);
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        TUser& user = users[i];
+        user.Id = usersView.Ids[i];
+        user.Balance = usersView.Balances[i];
+        user.Active = usersView.Active[i] != 0;
+        for (std::size_t f = 0; f < PayloadFields; ++f) {
+            user.Payload[f] = static_cast<float>(f);
+        }
+    }
+
+    VectorUserRepository<TUser> repository{std::move(users)};
+
+    std::println("Benchmarking {}-byte records...", sizeof(TUser));
+
+    WidthResults results{sizeof(TUser), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    float checksum = 0.0f;
+
+    results.RepositorySeconds = MeasureAverageTime(
+        warmupIterations, iterations, checksum, [&] {
+            return SumActiveBalances(repository, minimumBalance);
+        });
+    results.RepositoryChecksum = checksum;
+
+    results.AosSeconds = MeasureAverageTime(
+        warmupIterations, iterations, checksum, [&] {
+            return SumActiveBalancesAos(repository.GetUsers(), minimumBalance);
+        });
+
+    results.ScalarSeconds = MeasureAverageTime(
+        warmupIterations, iterations, checksum, [&] {
+            return SumActiveBalancesScalar(usersView, minimumBalance);
+        });
+
+    const SumActiveBalancesFn sumActiveBalances = ResolveSumActiveBalances();
+
+    results.Avx2Seconds = MeasureAverageTime(
+        warmupIterations, iterations, checksum, [&] {
+            return sumActiveBalances(usersView, minimumBalance);
+        });
+    results.Avx2Checksum = checksum;
+
+    return results;
+}
+
+int32_t main()
+{
+    constexpr std::size_t elementsCount = 10'000'000;
+    constexpr float minimumBalance = 250.0f;
+    constexpr uint_fast32_t randomSeed = 17;
+    constexpr std::size_t warmupIterations = 2;
+    constexpr std::size_t iterations = 8;
+
+    std::println("");
+    std::println("[ Wide Schema Benchmark ]");
+    std::println("Elements Count    : {}", elementsCount);
+    std::println("Minimum Balance   : {:.2f}", minimumBalance);
+    std::println("Random Seed       : {}", randomSeed);
+    std::println("Warmup Iterations : {}", warmupIterations);
+    std::println("Iterations        : {}", iterations);
+    std::println("Payload Fields    : 8, 32, 64");
+
+    std::mt19937 randomEngine{randomSeed};
+
+    std::println("");
+    std::println("Generating elements...");
+
+    /* The payload columns of the SoA layout would live in their own arrays
+     * and are never touched by the query, so only the scanned columns are
+     * materialized. */
+    UsersTable users;
+    GenerateUsers(users, elementsCount, randomEngine);
+
+    const UsersView usersView = MakeUsersView(users);
+
+    std::println("");
+
+    const WidthResults widthResults[] = {
+        BenchmarkWidth<8>(usersView, minimumBalance, warmupIterations, iterations),
+        BenchmarkWidth<32>(usersView, minimumBalance, warmupIterations, iterations),
+        BenchmarkWidth<64>(usersView, minimumBalance, warmupIterations, iterations),
+    };
+
+    const auto nanosecondsPerElement = [&](const double averageTimeSeconds) {
+        return (averageTimeSeconds * 1e9) / static_cast<double>(elementsCount);
+    };
+
+    std::println("");
+    std::println("[ Wide Schema Results (Nanoseconds per Element) ]");
+    std::println("{:>12} | {:>10} | {:>10} | {:>10} | {:>10} | {:>20} | {:>20}",
+                 "Record Bytes", "Repository", "AoS Loop", "DoD", "DoD AVX2",
+                 "Repository Checksum", "DoD AVX2 Checksum");
+
+    for (const WidthResults& results : widthResults) {
+        std::println("{:>12} | {:>10.2f} | {:>10.2f} | {:>10.2f} | {:>10.2f} | {:>20.2f} | {:>20.2f}",
+                     results.RecordBytes,
+                     nanosecondsPerElement(results.RepositorySeconds),
+                     nanosecondsPerElement(results.AosSeconds),
+                     nanosecondsPerElement(results.ScalarSeconds),
+                     nanosecondsPerElement(results.Avx2Seconds),
+                     results.RepositoryChecksum, results.Avx2Checksum);
+    }
+
+    std::println("");
+
+    return EXIT_SUCCESS;
+}
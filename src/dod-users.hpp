@@ -0,0 +1,472 @@
+/**
+ * Copyright (c) 2025 Mamadou Babaei
+ *
+ * Author: Mamadou Babaei <info@babaei.net>
+ *
+ */
+
+
+#pragma once
+
+/*******************************************************************************
+* Include directives
+*******************************************************************************/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif  /* defined(__AVX2__) */
+
+#include "lib.hpp"
+#include "soa-table.hpp"
+
+/*******************************************************************************
+* Types
+*******************************************************************************/
+
+struct UserSchema
+{
+    SOA_FIELD(Id, int32_t);
+    SOA_FIELD(Balance, float);
+    SOA_FIELD(Active, uint8_t);
+
+    using Fields = SoaFieldList<Id, Balance, Active>;
+};
+
+using UsersTable = SoaTable<UserSchema>;
+
+/* Read-only window over the three user columns. The kernels take nothing
+ * else, so a view of the whole table, of one partition or of one thread's
+ * range are all scanned the same way. */
+struct UsersView
+{
+    const int32_t* RESTRICT_ALIAS Ids;
+    const float* RESTRICT_ALIAS Balances;
+    const uint8_t* RESTRICT_ALIAS Active;
+    std::size_t Count;
+
+    /* Rows [offset, offset + length), like std::span::subspan. */
+    UsersView Subview(const std::size_t offset, const std::size_t length) const
+    {
+        return UsersView{Ids + offset, Balances + offset, Active + offset, length};
+    }
+};
+
+inline UsersView MakeUsersView(const std::span<const int32_t> ids,
+                               const std::span<const float> balances,
+                               const std::span<const uint8_t> activeFlags)
+{
+    assert(ids.size() == balances.size() && activeFlags.size() == balances.size());
+
+    return UsersView{ids.data(), balances.data(), activeFlags.data(), balances.size()};
+}
+
+inline UsersView MakeUsersView(const UsersTable& users)
+{
+    return MakeUsersView(users.Column<UserSchema::Id>(),
+                         users.Column<UserSchema::Balance>(),
+                         users.Column<UserSchema::Active>());
+}
+
+/*******************************************************************************
+* Data generation
+*******************************************************************************/
+
+/* Fills `users` with `count` rows: ids 0..count-1, balances uniform in
+ * [0, 1000) and 60% of users active. The engine is the caller's, so a run
+ * that generates several tables, or draws queries after the table, stays
+ * reproducible from one seed. */
+inline void GenerateUsers(UsersTable& users, const std::size_t count,
+                          std::mt19937& randomEngine)
+{
+    std::uniform_real_distribution<float> balanceDistribution{0.0f, 1000.0f};
+    std::bernoulli_distribution           activeDistribution{0.6};
+
+    users.Resize(count);
+
+    const std::span<int32_t> ids = users.Column<UserSchema::Id>();
+    const std::span<float> balances = users.Column<UserSchema::Balance>();
+    const std::span<uint8_t> activeFlags = users.Column<UserSchema::Active>();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        ids[i] = static_cast<int32_t>(i);
+        balances[i] = balanceDistribution(randomEngine);
+        activeFlags[i] = activeDistribution(randomEngine) ? 1u : 0u;
+    }
+}
+
+/*******************************************************************************
+* Kernels
+*******************************************************************************/
+
+FORCE_NOINLINE inline float SumActiveBalancesScalar(
+    const UsersView& usersView, const float minimumBalance)
+{
+    float accumulatedBalance = 0.0f;
+    const float thresholdBalance = minimumBalance;
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        const float balanceValue = usersView.Balances[i];
+        const float takeValue =
+            (usersView.Active[i] && balanceValue >= thresholdBalance)
+                ? 1.0f : 0.0f;
+        accumulatedBalance += balanceValue * takeValue;
+    }
+
+    return accumulatedBalance;
+}
+
+/* The double-accumulating variants trade some speed for a checksum that does
+ * not drift as the table grows. */
+FORCE_NOINLINE inline double SumActiveBalancesScalarDouble(
+    const UsersView& usersView, const float minimumBalance)
+{
+    double accumulatedBalance = 0.0;
+    const float thresholdBalance = minimumBalance;
+
+    for (std::size_t i = 0; i < usersView.Count; ++i) {
+        const float balanceValue = usersView.Balances[i];
+        const double takeValue =
+            (usersView.Active[i] && balanceValue >= thresholdBalance)
+                ? 1.0 : 0.0;
+        accumulatedBalance += static_cast<double>(balanceValue) * takeValue;
+    }
+
+    return accumulatedBalance;
+}
+
+#if defined(__AVX2__)
+FORCE_NOINLINE inline float SumActiveBalancesAvx2(
+    const UsersView& usersView, float minimumBalance)
+{
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 acc = _mm256_setzero_ps();
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n8; i += vectorWidth) {
+        __m256 b = _mm256_loadu_ps(&balances[i]);
+
+        __m128i bytes =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&activeFlags[i]));
+        __m256i ints = _mm256_cvtepu8_epi32(bytes);
+        __m256 activeM = _mm256_min_ps(_mm256_cvtepi32_ps(ints), one);
+
+        __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
+        __m256 take = _mm256_and_ps(cmpMask, activeM);
+        __m256 contrib = _mm256_mul_ps(b, take);
+
+        acc = _mm256_add_ps(acc, contrib);
+    }
+
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    float accumulatedBalance = _mm_cvtss_f32(sum);
+
+    for (; i < count; ++i) {
+        if (activeFlags[i] && balances[i] >= minimumBalance) {
+            accumulatedBalance += balances[i];
+        }
+    }
+
+    return accumulatedBalance;
+}
+
+/* Two independent accumulators over 16 rows per iteration with software
+ * prefetch 256 bytes ahead of both columns, tuned on Zen 2. */
+FORCE_NOINLINE inline float SumActiveBalancesZnver2(
+    const UsersView& usersView, float minimumBalance)
+{
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    constexpr int32_t prefetchDistance = 256;
+
+    constexpr std::size_t vectorWidth = 16;
+    const std::size_t n16 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n16; i += vectorWidth) {
+        _mm_prefetch(reinterpret_cast<const char*>(balances + i) + prefetchDistance, _MM_HINT_T0);
+        _mm_prefetch(reinterpret_cast<const char*>(activeFlags + i) + prefetchDistance, _MM_HINT_T0);
+
+        __m256 b0 = _mm256_loadu_ps(balances + i);
+        __m128i a8_0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i));
+        __m256i a32_0 = _mm256_cvtepu8_epi32(a8_0);
+        __m256 active0 = _mm256_min_ps(_mm256_cvtepi32_ps(a32_0), one);
+
+        __m256 cmp0 = _mm256_cmp_ps(b0, threshold, _CMP_GE_OQ);
+        __m256 contrib0 = _mm256_mul_ps(b0, _mm256_and_ps(cmp0, active0));
+
+        acc0 = _mm256_add_ps(acc0, contrib0);
+
+        __m256 b1 = _mm256_loadu_ps(balances + i + 8);
+        __m128i a8_1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i + 8));
+        __m256i a32_1 = _mm256_cvtepu8_epi32(a8_1);
+        __m256 active1 = _mm256_min_ps(_mm256_cvtepi32_ps(a32_1), one);
+
+        __m256 cmp1 = _mm256_cmp_ps(b1, threshold, _CMP_GE_OQ);
+        __m256 contrib1 = _mm256_mul_ps(b1, _mm256_and_ps(cmp1, active1));
+
+        acc1 = _mm256_add_ps(acc1, contrib1);
+    }
+
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 low = _mm256_castps256_ps128(acc);
+    __m128 high = _mm256_extractf128_ps(acc, 1);
+    __m128 sum = _mm_add_ps(low, high);
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+
+    float accumulatedBalance = _mm_cvtss_f32(sum);
+
+    for (; i < count; ++i) {
+        if (activeFlags[i] && balances[i] >= minimumBalance) {
+            accumulatedBalance += balances[i];
+        }
+    }
+
+    return accumulatedBalance;
+}
+
+/* Compares in float lanes and widens every 8 contributions to two __m256d
+ * accumulators. */
+FORCE_NOINLINE inline double SumActiveBalancesAvx2Double(
+    const UsersView& usersView, float minimumBalance)
+{
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+
+    constexpr std::size_t vectorWidth = 8;
+    const std::size_t n8 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n8; i += vectorWidth) {
+        __m256 b = _mm256_loadu_ps(&balances[i]);
+        __m128i bytes =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&activeFlags[i]));
+        __m256i ints = _mm256_cvtepu8_epi32(bytes);
+        __m256 activeM = _mm256_cvtepi32_ps(ints);
+        activeM = _mm256_min_ps(activeM, one);
+
+        __m256 cmpMask = _mm256_cmp_ps(b, threshold, _CMP_GE_OQ);
+        __m256 take = _mm256_and_ps(cmpMask, activeM);
+        __m256 contrib = _mm256_mul_ps(b, take);
+
+        __m128 low = _mm256_castps256_ps128(contrib);
+        __m128 high = _mm256_extractf128_ps(contrib, 1);
+
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(low));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(high));
+    }
+
+    __m256d acc = _mm256_add_pd(acc0, acc1);
+    __m128d low = _mm256_castpd256_pd128(acc);
+    __m128d high = _mm256_extractf128_pd(acc, 1);
+    __m128d sum = _mm_add_pd(low, high);
+    double accumulatedBalance =
+        _mm_cvtsd_f64(sum) + _mm_cvtsd_f64(_mm_unpackhi_pd(sum, sum));
+
+    for (; i < count; ++i) {
+        if (activeFlags[i] && balances[i] >= minimumBalance) {
+            accumulatedBalance += static_cast<double>(balances[i]);
+        }
+    }
+
+    return accumulatedBalance;
+}
+
+/* The Zen 2 loop of SumActiveBalancesZnver2 with four __m256d accumulators,
+ * one per half of each 8-row group. */
+FORCE_NOINLINE inline double SumActiveBalancesZnver2Double(
+    const UsersView& usersView, float minimumBalance)
+{
+    const std::size_t count = usersView.Count;
+    const float* RESTRICT_ALIAS balances = usersView.Balances;
+    const std::uint8_t* RESTRICT_ALIAS activeFlags = usersView.Active;
+
+    const __m256 threshold = _mm256_set1_ps(minimumBalance);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+
+    constexpr int32_t prefetchDistance = 256;
+
+    constexpr std::size_t vectorWidth = 16;
+    const std::size_t n16 = (count / vectorWidth) * vectorWidth;
+
+    std::size_t i = 0;
+    for (; i < n16; i += vectorWidth) {
+        _mm_prefetch(reinterpret_cast<const char*>(balances + i) + prefetchDistance, _MM_HINT_T0);
+        _mm_prefetch(reinterpret_cast<const char*>(activeFlags + i) + prefetchDistance, _MM_HINT_T0);
+
+        __m256 b0 = _mm256_loadu_ps(balances + i);
+        __m128i a8_0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i));
+        __m256i a32_0 = _mm256_cvtepu8_epi32(a8_0);
+        __m256 active0 = _mm256_min_ps(_mm256_cvtepi32_ps(a32_0), one);
+
+        __m256 cmp0 = _mm256_cmp_ps(b0, threshold, _CMP_GE_OQ);
+        __m256 contrib0 = _mm256_mul_ps(b0, _mm256_and_ps(cmp0, active0));
+
+        __m128 low0 = _mm256_castps256_ps128(contrib0);
+        __m128 high0 = _mm256_extractf128_ps(contrib0, 1);
+
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(low0));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(high0));
+
+        __m256 b1 = _mm256_loadu_ps(balances + i + 8);
+        __m128i a8_1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(activeFlags + i + 8));
+        __m256i a32_1 = _mm256_cvtepu8_epi32(a8_1);
+        __m256 active1 = _mm256_min_ps(_mm256_cvtepi32_ps(a32_1), one);
+
+        __m256 cmp1 = _mm256_cmp_ps(b1, threshold, _CMP_GE_OQ);
+        __m256 contrib1 = _mm256_mul_ps(b1, _mm256_and_ps(cmp1, active1));
+
+        __m128 low1 = _mm256_castps256_ps128(contrib1);
+        __m128 high1 = _mm256_extractf128_ps(contrib1, 1);
+
+        acc2 = _mm256_add_pd(acc2, _mm256_cvtps_pd(low1));
+        acc3 = _mm256_add_pd(acc3, _mm256_cvtps_pd(high1));
+    }
+
+    __m256d acc01 = _mm256_add_pd(acc0, acc1);
+    __m256d acc23 = _mm256_add_pd(acc2, acc3);
+    __m256d acc = _mm256_add_pd(acc01, acc23);
+
+    __m128d low = _mm256_castpd256_pd128(acc);
+    __m128d high = _mm256_extractf128_pd(acc, 1);
+    __m128d sum = _mm_add_pd(low, high);
+
+    double accumulatedBalance =
+        _mm_cvtsd_f64(sum) + _mm_cvtsd_f64(_mm_unpackhi_pd(sum, sum));
+
+    for (; i < count; ++i) {
+        if (activeFlags[i] && balances[i] >= minimumBalance) {
+            accumulatedBalance += static_cast<double>(balances[i]);
+        }
+    }
+
+    return accumulatedBalance;
+}
+#endif  /* defined(__AVX2__) */
+
+/*******************************************************************************
+* Dispatch
+*******************************************************************************/
+
+enum class EUsersKernel : uint8_t
+{
+    Scalar,
+    Avx2,
+    Znver2,
+};
+
+using SumActiveBalancesFn = float (*)(const UsersView&, float);
+
+/* Picks `preferred` if this build and this CPU can run it, the scalar
+ * kernel otherwise. Meant to be called once, with callers keeping the
+ * pointer. */
+inline SumActiveBalancesFn ResolveSumActiveBalances(
+    const EUsersKernel preferred = EUsersKernel::Avx2)
+{
+#if defined(__AVX2__)
+    bool bAvx2 = true;
+#if COMPILER_CLANG || COMPILER_GCC
+    bAvx2 = __builtin_cpu_supports("avx2");
+#endif  /* COMPILER_CLANG || COMPILER_GCC */
+
+    if (bAvx2) {
+        switch (preferred) {
+            case EUsersKernel::Avx2:
+                return SumActiveBalancesAvx2;
+            case EUsersKernel::Znver2:
+                return SumActiveBalancesZnver2;
+            case EUsersKernel::Scalar:
+                break;
+        }
+    }
+#else  /* defined(__AVX2__) */
+    (void)preferred;
+#endif  /* defined(__AVX2__) */
+
+    return SumActiveBalancesScalar;
+}
+
+using SumActiveBalancesDoubleFn = double (*)(const UsersView&, float);
+
+/* ResolveSumActiveBalances for the double-accumulating kernels. */
+inline SumActiveBalancesDoubleFn ResolveSumActiveBalancesDouble(
+    const EUsersKernel preferred = EUsersKernel::Avx2)
+{
+#if defined(__AVX2__)
+    bool bAvx2 = true;
+#if COMPILER_CLANG || COMPILER_GCC
+    bAvx2 = __builtin_cpu_supports("avx2");
+#endif  /* COMPILER_CLANG || COMPILER_GCC */
+
+    if (bAvx2) {
+        switch (preferred) {
+            case EUsersKernel::Avx2:
+                return SumActiveBalancesAvx2Double;
+            case EUsersKernel::Znver2:
+                return SumActiveBalancesZnver2Double;
+            case EUsersKernel::Scalar:
+                break;
+        }
+    }
+#else  /* defined(__AVX2__) */
+    (void)preferred;
+#endif  /* defined(__AVX2__) */
+
+    return SumActiveBalancesScalarDouble;
+}
+
+/* Dispatches on every call; for one-off scans where resolving up front is
+ * not worth the bookkeeping. */
+FORCE_NOINLINE inline float SumActiveBalances(
+    const UsersView& usersView, const float minimumBalance)
+{
+#if defined(__AVX2__)
+#if COMPILER_CLANG || COMPILER_GCC
+    if (__builtin_cpu_supports("avx2")) {
+        return SumActiveBalancesAvx2(usersView, minimumBalance);
+    }
+#endif  /* COMPILER_CLANG || COMPILER_GCC */
+    return SumActiveBalancesScalar(usersView, minimumBalance);
+#else  /* defined(__AVX2__) */
+    return SumActiveBalancesScalar(usersView, minimumBalance);
+#endif  /* defined(__AVX2__) */
+}
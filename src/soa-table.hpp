@@ -0,0 +1,239 @@
+/**
+ * Copyright (c) 2025 Mamadou Babaei
+ *
+ * Author: Mamadou Babaei <info@babaei.net>
+ *
+ */
+
+
+#pragma once
+
+/*******************************************************************************
+* Include directives
+*******************************************************************************/
+
+#include <cstddef>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "lib.hpp"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+
+/* Declares a column of a SoA schema as a tag type carrying its element type,
+ * e.g. `SOA_FIELD(Balance, float);` inside the schema struct. */
+#define SOA_FIELD(FieldName, FieldType)                                        \
+    struct FieldName                                                           \
+    {                                                                          \
+        using Type = FieldType;                                                \
+        static constexpr const char* Name = #FieldName;                        \
+    }
+
+/*******************************************************************************
+* Templates
+*******************************************************************************/
+
+inline constexpr std::size_t SoaColumnAlignment = 64;
+
+template <class T, std::size_t Alignment = SoaColumnAlignment>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <class U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+    {
+    }
+
+    [[nodiscard]] T* allocate(const std::size_t count)
+    {
+        return static_cast<T*>(::operator new(
+            count * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* const pointer, const std::size_t count) noexcept
+    {
+        ::operator delete(
+            pointer, count * sizeof(T), std::align_val_t{Alignment});
+    }
+
+    template <class U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+    {
+        return true;
+    }
+};
+
+template <class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/* Ordered list of the field tags of a schema; a schema is any struct that
+ * declares its fields with SOA_FIELD and lists them as
+ * `using Fields = SoaFieldList<...>;`. */
+template <class... Fields>
+struct SoaFieldList
+{
+    static constexpr std::size_t Count = sizeof...(Fields);
+};
+
+template <class Field, class... Fields>
+consteval std::size_t SoaFieldIndex()
+{
+    constexpr bool matches[] = {std::is_same_v<Field, Fields>...};
+
+    for (std::size_t i = 0; i < sizeof...(Fields); ++i) {
+        if (matches[i]) {
+            return i;
+        }
+    }
+
+    return sizeof...(Fields);
+}
+
+template <class Schema, class FieldList = typename Schema::Fields>
+class SoaTable;
+
+/* Struct-of-arrays storage generated from a schema: one 64-byte aligned
+ * column per field, typed spans over each column, row proxies for the
+ * occasional per-record access, and zipped iteration over a subset of
+ * columns through restrict-qualified pointers so hot loops vectorize. */
+template <class Schema, class... Fields>
+class SoaTable<Schema, SoaFieldList<Fields...>>
+{
+public:
+    template <class Field>
+    static constexpr std::size_t FieldIndex = SoaFieldIndex<Field, Fields...>();
+
+    template <bool bConst>
+    class RowProxy
+    {
+    public:
+        using TableType = std::conditional_t<bConst, const SoaTable, SoaTable>;
+
+        RowProxy(TableType& table, const std::size_t index)
+            : Table(&table)
+            , Index(index)
+        {
+        }
+
+        template <class Field>
+        decltype(auto) Get() const
+        {
+            return Table->template Column<Field>()[Index];
+        }
+
+        std::size_t GetIndex() const
+        {
+            return Index;
+        }
+
+    private:
+        TableType* Table;
+        std::size_t Index;
+    };
+
+    std::size_t Size() const
+    {
+        return std::get<0>(Columns).size();
+    }
+
+    bool Empty() const
+    {
+        return Size() == 0;
+    }
+
+    void Reserve(const std::size_t count)
+    {
+        std::apply([&](auto&... columns) { (columns.reserve(count), ...); },
+                   Columns);
+    }
+
+    void Resize(const std::size_t count)
+    {
+        std::apply([&](auto&... columns) { (columns.resize(count), ...); },
+                   Columns);
+    }
+
+    void Clear()
+    {
+        std::apply([](auto&... columns) { (columns.clear(), ...); }, Columns);
+    }
+
+    void PushBack(const typename Fields::Type&... values)
+    {
+        PushBackColumns(std::index_sequence_for<Fields...>{}, values...);
+    }
+
+    template <class Field>
+    std::span<typename Field::Type> Column()
+    {
+        static_assert(FieldIndex<Field> < sizeof...(Fields),
+                      "Field is not part of the schema");
+        return std::get<FieldIndex<Field>>(Columns);
+    }
+
+    template <class Field>
+    std::span<const typename Field::Type> Column() const
+    {
+        static_assert(FieldIndex<Field> < sizeof...(Fields),
+                      "Field is not part of the schema");
+        return std::get<FieldIndex<Field>>(Columns);
+    }
+
+    RowProxy<false> Row(const std::size_t index)
+    {
+        return RowProxy<false>{*this, index};
+    }
+
+    RowProxy<true> Row(const std::size_t index) const
+    {
+        return RowProxy<true>{*this, index};
+    }
+
+    /* Calls `fn(values...)` for every row with the values of the `Selected`
+     * columns, in order; the columns never alias, which the loop states. */
+    template <class... Selected, class F>
+    void ForEachZipped(F&& fn) const
+    {
+        ZipLoop(fn, Size(), Column<Selected>().data()...);
+    }
+
+    template <class... Selected, class F>
+    void ForEachZippedMutable(F&& fn)
+    {
+        ZipLoop(fn, Size(), Column<Selected>().data()...);
+    }
+
+private:
+    template <std::size_t... Indices>
+    void PushBackColumns(std::index_sequence<Indices...>,
+                         const typename Fields::Type&... values)
+    {
+        (std::get<Indices>(Columns).push_back(values), ...);
+    }
+
+    template <class F, class... Ts>
+    static void ZipLoop(F& fn, const std::size_t count,
+                        Ts* RESTRICT_ALIAS... columns)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(columns[i]...);
+        }
+    }
+
+    std::tuple<AlignedVector<typename Fields::Type>...> Columns;
+};
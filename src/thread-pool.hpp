@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2025 Mamadou Babaei
+ *
+ * Author: Mamadou Babaei <info@babaei.net>
+ *
+ */
+
+
+#pragma once
+
+/*******************************************************************************
+* Include directives
+*******************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*******************************************************************************
+* Classes
+*******************************************************************************/
+
+/* Fixed set of worker threads running fork-join jobs. A job is a task count
+ * and a callable invoked once per task index; workers and the calling thread
+ * claim indices from a shared counter, and ParallelFor returns once every
+ * task has run. Task counts must fit in 32 bits. There is one job at a
+ * time, so the pool is meant to be driven by a single thread. */
+class ThreadPool
+{
+public:
+    /* `threadsCount` includes the calling thread, so a pool of one runs
+     * everything inline. */
+    explicit ThreadPool(const std::size_t threadsCount)
+    {
+        const std::size_t workersCount = std::max<std::size_t>(1, threadsCount) - 1;
+
+        Workers.reserve(workersCount);
+        for (std::size_t i = 0; i < workersCount; ++i) {
+            Workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            bStopping = true;
+        }
+        WorkAvailable.notify_all();
+
+        for (std::thread& worker : Workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t GetThreadsCount() const
+    {
+        return Workers.size() + 1;
+    }
+
+    /* Runs `fn(task)` for every task in [0, tasksCount) and waits for all of
+     * them. Tasks run concurrently, so `fn` must be safe to call from
+     * several threads at once. */
+    template <class F>
+    void ParallelFor(const std::size_t tasksCount, F&& fn)
+    {
+        if (tasksCount == 0) {
+            return;
+        }
+
+        /* Claims keep the task index in the low 32 bits; a larger count
+         * would carry into the job tag. */
+        assert(tasksCount <= std::numeric_limits<uint32_t>::max());
+
+        if (Workers.empty() || tasksCount == 1) {
+            for (std::size_t task = 0; task < tasksCount; ++task) {
+                fn(task);
+            }
+            return;
+        }
+
+        using Callable = std::remove_reference_t<F>;
+
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock{Mutex};
+            ++Generation;
+
+            job.Context = const_cast<void*>(static_cast<const void*>(&fn));
+            job.Invoke = [](void* context, const std::size_t task) {
+                (*static_cast<Callable*>(context))(task);
+            };
+            job.TasksCount = tasksCount;
+            job.Tag = static_cast<uint32_t>(Generation);
+
+            CurrentJob = job;
+            RemainingTasks.store(tasksCount, std::memory_order_relaxed);
+            NextClaim.store(PackClaim(job.Tag, 0), std::memory_order_release);
+        }
+        WorkAvailable.notify_all();
+
+        RunTasks(job);
+
+        std::unique_lock<std::mutex> lock{Mutex};
+        JobDone.wait(lock, [this] {
+            return RemainingTasks.load(std::memory_order_acquire) == 0
+                && ActiveWorkers == 0;
+        });
+    }
+
+    /* Splits [0, count) into at most one contiguous range per thread, sized
+     * to a multiple of `grain`, and runs `fn(range, begin, end)` on each. */
+    template <class F>
+    void ParallelForRange(const std::size_t count, const std::size_t grain,
+                          F&& fn)
+    {
+        const std::size_t threadsCount = GetThreadsCount();
+        const std::size_t rangeSize =
+            ((count + threadsCount - 1) / threadsCount + grain - 1) / grain * grain;
+        const std::size_t rangesCount =
+            rangeSize == 0 ? 0 : (count + rangeSize - 1) / rangeSize;
+
+        ParallelFor(rangesCount, [&](const std::size_t range) {
+            const std::size_t begin = range * rangeSize;
+            fn(range, begin, std::min(count, begin + rangeSize));
+        });
+    }
+
+private:
+    /* One ParallelFor call. Workers copy it under the mutex before claiming
+     * anything, so they never read job fields the next call is writing. */
+    struct Job
+    {
+        void* Context = nullptr;
+        void (*Invoke)(void*, std::size_t) = nullptr;
+        std::size_t TasksCount = 0;
+        uint32_t Tag = 0;
+    };
+
+    /* A claim is the job's tag in the high half and the next task index in
+     * the low half, so a worker holding a finished job's copy cannot take
+     * an index that belongs to the job after it. */
+    static uint64_t PackClaim(const uint32_t tag, const uint32_t task)
+    {
+        return (static_cast<uint64_t>(tag) << 32) | task;
+    }
+
+    void WorkerLoop()
+    {
+        uint64_t seenGeneration = 0;
+
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock{Mutex};
+                WorkAvailable.wait(lock, [&] {
+                    return bStopping || Generation != seenGeneration;
+                });
+
+                if (bStopping) {
+                    return;
+                }
+
+                seenGeneration = Generation;
+                job = CurrentJob;
+                ++ActiveWorkers;
+            }
+
+            RunTasks(job);
+
+            std::lock_guard<std::mutex> lock{Mutex};
+            --ActiveWorkers;
+            if (ActiveWorkers == 0) {
+                JobDone.notify_all();
+            }
+        }
+    }
+
+    void RunTasks(const Job& job)
+    {
+        uint64_t claim = NextClaim.load(std::memory_order_acquire);
+
+        while (true) {
+            const uint32_t tag = static_cast<uint32_t>(claim >> 32);
+            const std::size_t task = static_cast<uint32_t>(claim);
+            if (tag != job.Tag || task >= job.TasksCount) {
+                return;
+            }
+
+            if (!NextClaim.compare_exchange_weak(claim, claim + 1,
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+                continue;
+            }
+
+            job.Invoke(job.Context, task);
+
+            if (RemainingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock{Mutex};
+                JobDone.notify_all();
+            }
+
+            claim = NextClaim.load(std::memory_order_acquire);
+        }
+    }
+
+    std::vector<std::thread> Workers;
+
+    std::mutex Mutex;
+    std::condition_variable WorkAvailable;
+    std::condition_variable JobDone;
+    uint64_t Generation = 0;
+    std::size_t ActiveWorkers = 0;
+    bool bStopping = false;
+
+    Job CurrentJob;
+    std::atomic<uint64_t> NextClaim{0};
+    std::atomic<std::size_t> RemainingTasks{0};
+};